@@ -0,0 +1,14 @@
+#include "atmosphere.h"
+
+void CorrectDragCoefficients(const double* DragCoefficient, const Atmosphere& Weather, double* Corrected, int Count)
+{
+   double factor = AtmosphericCorrection(Weather);
+   for (int i = 0; i < Count; i++)
+      Corrected[i] = DragCoefficient[i] * factor;
+}
+
+void CorrectDragCoefficients(double DragCoefficient, const Atmosphere* Weather, double* Corrected, int Count)
+{
+   for (int i = 0; i < Count; i++)
+      Corrected[i] = DragCoefficient * AtmosphericCorrection(Weather[i]);
+}
@@ -0,0 +1,64 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _ATMOSPHERE_
+#define _ATMOSPHERE_
+
+// The atmospheric correction of Projectile::DragCoefficientAtmosphericCorrection, as pure functions of
+// the weather: nothing is modified, so they can be called any number of times, from any thread.
+//
+// The correction is the product of four factors, for altitude, temperature, pressure and humidity:
+//    DragCoefficient * FA(A) * (1 + FT(T, A) - FP(P)) * FRH(T, P, RH)
+// with the polynomials in A and T evaluated by Horner's rule.
+
+// The weather a drag coefficient is corrected for.
+struct Atmosphere
+{
+   double Altitude_feet;     // above sea level.  Standard altitude is 0 feet.
+   double Barometer_hg;      // "standardized" pressure, as reported in the news, in in Hg.  Standard pressure is 29.53 in Hg.
+   double Temperature_f;     // in degrees Fahrenheit.  Standard temperature is 59 degrees.
+   double RelativeHumidity;  // a fraction, 0 to 1.  Standard humidity is 0.78.
+};
+
+// The four factors, as Projectile::CalculateFactorA and the others return them.
+inline double AtmosphereFactorA(double Altitude)
+{
+   return 1 / (((-4e-15 * Altitude + 4e-10) * Altitude - 3e-5) * Altitude + 1);
+}
+
+inline double AtmosphereFactorT(double Temperature, double Altitude)
+{
+   double Tstd = -0.0036 * Altitude + 59;
+   return (Temperature - Tstd) / (459.6 + Tstd);
+}
+
+inline double AtmosphereFactorP(double Pressure)
+{
+   double Pstd = 29.53; // in-hg
+   return (Pressure - Pstd) / Pstd;
+}
+
+inline double AtmosphereFactorRH(double Temperature, double Pressure, double RelativeHumidity)
+{
+   double VPw = ((4e-6 * Temperature - 0.0004) * Temperature + 0.0234) * Temperature - 0.2517;
+   return 0.995 * (Pressure / (Pressure - 0.3783 * RelativeHumidity * VPw));
+}
+
+// The factor a drag coefficient is multiplied by to correct it for the weather.
+inline double AtmosphericCorrection(const Atmosphere& Weather)
+{
+   double FA = AtmosphereFactorA(Weather.Altitude_feet);
+   double FT = AtmosphereFactorT(Weather.Temperature_f, Weather.Altitude_feet);
+   double FP = AtmosphereFactorP(Weather.Barometer_hg);
+   double FR = AtmosphereFactorRH(Weather.Temperature_f, Weather.Barometer_hg, Weather.RelativeHumidity);
+   return FA * (1 + FT - FP) * FR;
+}
+
+// Corrects Count drag coefficients for the same weather.
+void CorrectDragCoefficients(const double* DragCoefficient, const Atmosphere& Weather, double* Corrected, int Count);
+
+// Corrects one drag coefficient for Count weather samples.
+void CorrectDragCoefficients(double DragCoefficient, const Atmosphere* Weather, double* Corrected, int Count);
+
+#endif
@@ -7,7 +7,6 @@
 
 #define BCOMP_MAXRANGE 50000
 #define GRAVITY (-32.194)
-#define M_PI (3.1415926535897)
 
 #define DegtoMOA(deg) ((deg)*60)  // Converts degrees to minutes of angle
 #define DegtoRad(deg) ((deg)*0.01745329251994329576923690768489)	// Converts degrees to radians
@@ -19,9 +18,14 @@
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <conio.h>
 
-enum EDragFunction { G1=1, G2, G3, G4, G5, G6, G7, G8 };
+#ifndef M_PI
+#define M_PI (3.1415926535897)
+#endif
+
+// Drag models registered at run time (see drag.h) get the values from GCustom to GCustomLast.
+// G3 and G4 have no built-in model: DragRetardationVelocity returns -1 for them unless SetDragModel sets one.
+enum EDragFunction { G1=1, G2, G3, G4, G5, G6, G7, G8, GCustom, GCustomLast=31 };
 
 struct ProjectilePath
 {
@@ -36,10 +40,100 @@ struct ProjectilePath
    double Vy; // the velocity of the projectile perpendicular to the bore direction.
 };
 
+// Receives ProjectilePath rows as Projectile::Update produces them (see Projectile::StreamPath).
+// Context is the pointer given to StreamPath.
+typedef void (*ProjectilePathSink)(const ProjectilePath& Row, void* Context);
+
+// Bits selecting ProjectilePath columns (see Projectile::PathColumns and SolveTable), in the order of its fields.
+enum EPathColumn
+{
+   PATH_RANGE = 1,
+   PATH_PATH = 2,
+   PATH_MOA = 4,
+   PATH_TIME = 8,
+   PATH_WINDAGE = 16,
+   PATH_WINDAGEMOA = 32,
+   PATH_VELOCITY = 64,
+   PATH_VX = 128,
+   PATH_VY = 256,
+   PATH_ALL = 511
+};
+
 // For very steep shooting angles, Vx can actually become what you would think of as Vy relative to the ground, 
 // because Vx is referencing the bore's axis.  All computations are carried out relative to the bore's axis, and
 // have very little to do with the ground's orientation.
 
+// The integration methods a Projectile can use.
+//    Trapezoidal:  fixed 0.5 ft steps (dt = 0.5 / v) with trapezoidal position updates.  The default.
+//    RK45:  adaptive Dormand-Prince 5(4) steps with error control (see integrator.h).
+//           ProjectilePath rows are interpolated at exact yards from the dense output.
+enum EIntegrator { Trapezoidal, RK45 };
+
+#define RK45_TOLERANCE 1e-6 // Default local error tolerance per RK45 step, in feet and ft/s.
+
+#define ZERO_TOLERANCE MOAtoRad(0.0001) // CalculateSightToBoreAngle stops once its angle changes by less than this, in radians.
+#define ZERO_MAXITERATIONS 50
+
+#define SPEEDOFSOUND 1116.45 // Standard speed of sound (59 degrees F), in ft/s.
+
+// Events Projectile::Advance reports, as bits for Projectile::Events.
+enum EProjectileEvent
+{
+   EVENT_LINEOFSIGHT = 1,  // the path crossed the line of sight, going up or down
+   EVENT_TARGET = 2,       // the projectile reached TargetRange
+   EVENT_TRANSONIC = 4,    // the airspeed fell below Mach 1.2
+   EVENT_SUBSONIC = 8,     // the airspeed fell below Mach 1
+   EVENT_GROUND = 16,      // the projectile hit the ground, and stopped there
+   EVENT_ALL = 31
+};
+
+// Where and when an event happened, interpolated to the moment it happened within the step.
+struct ProjectileEvent
+{
+   EProjectileEvent Event;
+   double Time;      // time of flight, in s
+   double Range;     // in yards, along the line of sight
+   double Path;      // in inches, relative to the line of sight
+   double Windage;   // in inches
+   double Velocity;  // in ft/s
+};
+
+// Receives events from Projectile::Advance.  Context is the projectile's EventContext.
+typedef void (*ProjectileEventHandler)(const ProjectileEvent& Event, void* Context);
+
+// The state of a flight between two steps, to resume it from (see Projectile::SaveCheckpoint).
+struct FlightCheckpoint
+{
+   double vx;
+   double vy;
+   double x;
+   double y;
+   double t;
+   double Gx;
+   double Gy;
+   int ProjectilePathCount;  // the recording cursor: the next row to produce
+   double dt;                // the next step, as Update set it
+};
+
+class RetardationTable;
+
+// The derivative an RK45 step of Update ended with.  Dormand-Prince evaluates it as its last stage, and
+// it is also the first stage of the next step, so Update starts from it instead of evaluating the drag
+// again, as long as the projectile still flies as it did at the end of that step.
+struct RK45Derivative
+{
+   int Valid;
+   double vx;
+   double vy;
+   double Gx;
+   double Gy;
+   double headwind_feet_sec;
+   double DragCoefficient;
+   EDragFunction DragFunction;
+   const RetardationTable* pRetardationTable;
+   double D[4];  // vx, vy, ax, ay, as in integrator.h
+};
+
 class Projectile
 {
 public:
@@ -49,8 +143,18 @@ public:
    double x;
    double y;
 
+   // Trajectory recording.  Update produces a ProjectilePath row every PathInterval yards, and the
+   // flight ends after PathRows rows, at PathMaxRange yards.  Rows are only computed when they are kept:
+   // in aProjectilePath (see RecordPath), or by PathSink (see StreamPath).  By default nothing is kept,
+   // and ProjectilePathCount just counts the rows passed.
    int ProjectilePathCount;
-   ProjectilePath* aProjectilePath;
+   ProjectilePath* aProjectilePath; // NULL unless RecordPath was called
+   double PathMaxRange;             // in yards
+   double PathInterval;             // in yards
+   int PathRows;                    // PathMaxRange / PathInterval + 1: the rows in a full flight, and in aProjectilePath
+   ProjectilePathSink PathSink;
+   void* PathSinkContext;
+   int PathColumns;                 // EPathColumn bits: the fields computed in each row; the rest are left 0.  PATH_ALL by default.
 
    double t;
    double Gx;
@@ -60,6 +164,23 @@ public:
    double MuzzleVelocity;
    double SightHeightOverBore;
 
+   // Optional precomputed drag curve (see retardationtable.h), used instead of the drag function when set.
+   // It must match DragFunction and DragCoefficient; NULL by default.
+   const RetardationTable* pRetardationTable;
+
+   EIntegrator Integrator;
+   double Tolerance; // RK45 only: the local error allowed per step, in feet and ft/s.
+
+   // Real time stepping (see Advance).  Events are only looked for while EventHandler is set.
+   ProjectileEventHandler EventHandler;
+   void* EventContext;
+   int Events;                   // EProjectileEvent bits: the events to report.  EVENT_ALL by default.
+   double TargetRange;           // the range of EVENT_TARGET, in yards, or 0 for none
+   double SightHeightOverGround; // the height of the line of sight's origin above level ground, in feet, or 0 for no ground
+   double SpeedOfSound;          // in ft/s, for EVENT_TRANSONIC and EVENT_SUBSONIC.  SPEEDOFSOUND by default.
+   double AdvanceStep;           // RK45 only: the step the error control proposes for Advance to take next, in s
+   RK45Derivative UpdateDerivative; // RK45 only: the derivative the last step of Update ended with
+
    Projectile(double DragCoefficient, EDragFunction DragFunction, double MuzzleVelocity, double SightHeightOverBore)
    {
       this->DragCoefficient = DragCoefficient;
@@ -67,15 +188,101 @@ public:
       this->MuzzleVelocity = MuzzleVelocity;
       this->SightHeightOverBore = SightHeightOverBore;
 
-      aProjectilePath = new ProjectilePath[BCOMP_MAXRANGE];
+      // At rest at the muzzle until Fire, so that copies of an unfired projectile copy defined values.
+      this->vx = 0;
+      this->vy = 0;
+      this->x = 0;
+      this->y = 0;
+      this->t = 0;
+      this->Gx = 0;
+      this->Gy = 0;
+      this->ProjectilePathCount = 0;
+
+      this->pRetardationTable = NULL;
+      this->Integrator = Trapezoidal;
+      this->Tolerance = RK45_TOLERANCE;
+
+      this->EventHandler = NULL;
+      this->EventContext = NULL;
+      this->Events = EVENT_ALL;
+      this->TargetRange = 0;
+      this->SightHeightOverGround = 0;
+      this->SpeedOfSound = SPEEDOFSOUND;
+      this->AdvanceStep = 0;
+      this->UpdateDerivative = RK45Derivative(); // all 0: not Valid
+
+      this->aProjectilePath = NULL;
+      this->PathMaxRange = BCOMP_MAXRANGE-1;
+      this->PathInterval = 1;
+      this->PathRows = BCOMP_MAXRANGE;
+      this->PathSink = NULL;
+      this->PathSinkContext = NULL;
+      this->PathColumns = PATH_ALL;
    }
    ~Projectile()
    {
       delete[] aProjectilePath;
    }
 
+   // Copies are deep: each projectile owns its own aProjectilePath.  Moves take it over instead.
+   Projectile(const Projectile& other);
+   Projectile(Projectile&& other);
+   Projectile& operator=(const Projectile& other);
+   Projectile& operator=(Projectile&& other);
+
+   // Keeps the ProjectilePath rows in aProjectilePath, sized for the given range and row interval.
+   void RecordPath(double MaxRange_yard, double RowInterval_yard = 1);
+   /* Arguments:
+         MaxRange_yard:  The range at which the flight ends, in yards.
+         RowInterval_yard:  The distance between rows, in yards.  Row i is at i * RowInterval_yard yards.
+
+      aProjectilePath then holds up to MaxRange_yard / RowInterval_yard + 1 rows, and ProjectilePathCount
+      the number filled so far.  Any sink set by StreamPath is kept.
+   */
+
+   // Sends the ProjectilePath rows to Sink as they are produced, without keeping them.
+   void StreamPath(ProjectilePathSink Sink, void* Context, double MaxRange_yard = BCOMP_MAXRANGE-1, double RowInterval_yard = 1);
+   /* Arguments:
+         Sink:  The function to call with each row, or NULL to stop streaming.
+         Context:  Passed on to Sink with each row.
+         MaxRange_yard, RowInterval_yard:  As for RecordPath.  Any rows kept by RecordPath are dropped.
+   */
+
    void Fire(double BoreAngle, double SightToBoreAngle);
    int Update(double &dt, double headwind_mile_hr, double crosswind_mile_hr);
+   /* Advances the projectile by one integration step, producing a ProjectilePath row for each row passed.
+      With the Trapezoidal integrator, dt is the step to take; with RK45, it is the proposed step (0 to
+      let the integrator choose), and the RK45 step also advances t.  Either way, dt is set to the next step.
+      Returns 0 when the projectile is done (too steep, or past PathMaxRange), 1 otherwise.
+   */
+
+   // Advances the projectile by Seconds of flight, for real time loops that step it themselves.
+   // The time is split into stable substeps: 0.5 ft ones for Trapezoidal, error controlled ones for RK45.
+   // No ProjectilePath rows are produced.  Instead, events are reported to EventHandler as they happen,
+   // in the order they happen.  t is the exact time of flight.
+   int Advance(double Seconds, double headwind_mile_hr, double crosswind_mile_hr);
+   /* Returns 0 when the projectile is done: it hit the ground (and stopped there), got too steep,
+      or passed PathMaxRange.  Returns 1 otherwise.
+   */
+
+   // Snapshots the flight between two steps of Update, with dt the step Update set, and puts it back.
+   // Resuming restores dt, and the flight goes on exactly as it would have: the same steps, and the
+   // same rows from the cursor on.  Rows already produced are left alone, so those in aProjectilePath
+   // before the cursor are kept.
+   void SaveCheckpoint(FlightCheckpoint& Checkpoint, double dt) const;
+   void Resume(const FlightCheckpoint& Checkpoint, double& dt);
+
+   // The RK45 step behind Update (see integrator.h).
+   int UpdateRK45(double &dt, double headwind_mile_hr, double crosswind_mile_hr);
+
+   // Produces the next ProjectilePath row: keeps it, streams it, or just counts it.
+   void RecordPathRow(double x, double y, double time, double v, double vx, double vy, double crosswind_mile_hr);
+
+   // Computes a ProjectilePath row for a point of the flight, with only the given EPathColumn bits filled in.
+   ProjectilePath PathRow(double x, double y, double time, double v, double vx, double vy, double crosswind_mile_hr, int Columns);
+
+   // The range of the next ProjectilePath row, in feet.
+   double NextPathRange_feet() const { return 3*(ProjectilePathCount*PathInterval); }
 
    // A function to calculate ballistic retardation values based on standard drag functions.
    double DragRetardationVelocity(double Velocity);
@@ -109,6 +316,9 @@ public:
 
       Return Value:
          The function returns a ballistic coefficient, corrected for the supplied atmospheric conditions.
+
+         It also sets DragCoefficient to it, so calling it twice corrects twice.  AtmosphericCorrection
+         (see atmosphere.h) returns the same factor without modifying anything.
    */
 
 
@@ -144,10 +354,40 @@ public:
                   to sight your rifle in 1.5" high at 100 yards, then you would set yIntercept to 1.5, and ZeroRange to 100
                   
       Return Value:
-         Returns the angle of the bore relative to the sighting system, in degrees.
+         Returns the angle of the bore relative to the sighting system, in degrees, or 0 if ZeroRange is not positive.
    */
+
+   // The same, starting the search from a previous solution, such as the zero before a change in the atmosphere.
+   // A close WarmStartAngle saves one or two trial shots.
+   // Each trial shot flies out to the zero range and no further, so the search costs more the longer the zero.
+   // The RK45 search takes about 16 microseconds at 300 yards and 60 at 600.  The Trapezoidal trial shot takes
+   // a step per foot, so its search takes about 35 microseconds at 100 yards and 70 at 200: to re-zero within
+   // 50 microseconds beyond 100 yards, use RK45.
+   double CalculateSightToBoreAngle(double ZeroRange_yard, double yIntercept_inch, double WarmStartAngle_deg);
+
+   // The trial shot behind CalculateSightToBoreAngle: the projectile's height, in feet, at Range_feet, when fired
+   // with no wind at Angle radians above the line of sight.  Integration stops as soon as the projectile passes
+   // Range_feet, or gets too steep to reach it.
+   double ZeroTrialHeight(double Angle, double Range_feet);
+
+private:
+   // Copies everything but aProjectilePath.
+   void CopyState(const Projectile& other);
 };
 
+// The drag function behind Projectile::DragRetardationVelocity, for callers that keep projectile state
+// outside of a Projectile object (see ProjectileBatch).
+double DragRetardationVelocity(EDragFunction DragFunction, double DragCoefficient, double Velocity);
+/* Arguments:
+      DragFunction:  G1, G2, G3, G4, G5, G6, G7, or G8.  All are enumerated above.
+      DragCoefficient:  The coefficient of drag for the projectile for the given drag function.
+      Velocity:  The Velocity of the projectile.
+
+   Return Value:
+      The function returns the projectile drag retardation velocity, in ft/s per second,
+      or -1 if the drag function or velocity is out of range.
+*/
+
 // Functions to resolve any wind / angle combination into headwind and crosswind components.
 double HeadWindVelocity(double WindSpeed_mile_hr, double WindAngle);
 double CrossWindVelocity(double WindSpeed_mile_hr, double WindAngle);
@@ -165,7 +405,9 @@ double CrossWindVelocity(double WindSpeed_mile_hr, double WindAngle);
 
 // bore = the hollow part inside a gun barrel or other tube.
 
-// A function to generate a ballistic solution table in 1 yard increments, up to BCOMP_MAXRANGE.
+// A function to generate a ballistic solution table, one row every PathInterval yards up to PathMaxRange
+// (by default, BCOMP_MAXRANGE rows in 1 yard increments), kept or streamed as set up by the projectile's
+// RecordPath or StreamPath.
 int SolveAll(double WindSpeed_mile_hr, double WindAngle, Projectile& projectile);
 /* Arguments:
       DragFunction:  The drag function you wish to use for the solution (G1, G2, G3, G5, G6, G7, or G8)
@@ -188,9 +430,53 @@ int SolveAll(double WindSpeed_mile_hr, double WindAngle, Projectile& projectile)
                to worry about it.  This solution can be passed to the retrieval functions to get
                useful data from the solution.
       Return Value:
-               This function returns an integer representing the maximum valid range of the
-               solution.  This also indicates the maximum number of rows in the solution matrix,
+               This function returns an integer representing the number of rows in the solution.
+               This is also the number of valid rows in aProjectilePath (when it is recorded),
                and should not be exceeded in order to avoid a memory segmentation fault.
 */
 
+// A function to generate a ballistic solution table with only some of the columns, packed into
+// a caller supplied array.  Columns that are not requested are never computed.
+int SolveTable(double WindSpeed_mile_hr, double WindAngle, Projectile& projectile, double RangeStep_yard, double MaxRange_yard, int Columns, double* Table);
+/* Arguments:
+      WindSpeed, WindAngle:  As for SolveAll.
+      projectile:  A projectile that has been fired.  SolveTable streams its rows into Table and computes
+                   only Columns for the call, then puts its recording back as it was: the rows RecordPath
+                   kept, ProjectilePathCount, any StreamPath sink, and PathColumns.  The flight itself is left
+                   where SolveTable ended it, so Fire the projectile again before solving it again.
+      RangeStep_yard:  The distance between rows, in yards.  Row i is at i * RangeStep_yard yards.
+      MaxRange_yard:  The range of the last row, in yards.
+      Columns:  EPathColumn bits selecting the columns.
+      Table:  Receives the rows, each one the selected columns in the order of the ProjectilePath fields.
+              It must have room for PathTableRows(MaxRange_yard, RangeStep_yard) * PathColumnCount(Columns) doubles.
+
+   Return Value:
+      The number of rows written to Table.
+*/
+
+// A function to solve for the path at a few given ranges, instead of a row at every PathInterval.
+// The projectile flies only as far as the farthest range, and each row is interpolated at its exact
+// range from the integration step that passed it, with the same cubic Hermite dense output RK45 uses.
+int SolveRanges(double WindSpeed_mile_hr, double WindAngle, Projectile& projectile, const double* Range_yard, int Count, ProjectilePath* Rows);
+/* Arguments:
+      WindSpeed, WindAngle:  As for SolveAll.
+      projectile:  A projectile that has been fired.  It is flown on from where it is, as by SolveAll, so
+                   any rows it records or streams are produced along the way.  Its PathColumns select the
+                   columns computed.
+      Range_yard:  The ranges, in yards, in any order.
+      Count:  The number of ranges.
+      Rows:  Receives Count rows, one per range, in the same order.  Range is always filled in.
+             Rows of ranges that are not reached are left 0 apart from Range.
+
+   Return Value:
+      The number of ranges reached: all of them, unless the projectile stops short (too steep, or at
+      its PathMaxRange), or some were behind it to begin with.
+*/
+
+// The number of columns selected by EPathColumn bits.
+int PathColumnCount(int Columns);
+
+// The number of rows in a solution table out to MaxRange_yard, one every RangeStep_yard yards.
+int PathTableRows(double MaxRange_yard, double RangeStep_yard);
+
 #endif
@@ -0,0 +1,231 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _BASICPROJECTILE_
+#define _BASICPROJECTILE_
+
+#include "ballistics.h"
+#include "dragbands.h"
+#include "instrument.h"
+
+// Compile time drag functions, and the trapezoidal integration loops built on them.
+//
+// A Projectile looks its drag function up in the registry (see drag.h) on every step.  StandardDrag<G7>
+// compiles G7's bands in instead: the band search becomes a fixed tree of comparisons against constants,
+// unrolled and inlined into the step, with no registry or grid to load.  The results are the same, bit
+// for bit.  The trapezoidal step and trial shot below take the drag as a template parameter, and SolveAll
+// and CalculateSightToBoreAngle pick StandardDrag for any projectile it applies to, once per flight, so
+// the existing Projectile API gets the inlined loops without any change.  BasicProjectile<G7> does the
+// same for callers who step the projectile themselves.
+//
+// The RK45 integrator looks up its band once per step and forces it on the step's stages (see
+// integrator.h), so it keeps using the registry.
+
+// The band of Bands that applies to Velocity, found by binary search among Bands[Low] to Bands[High].
+template <class Bands, int Low, int High, bool Found = (Low == High)>
+struct StandardDragBandSearch
+{
+   static int Find(double Velocity)
+   {
+      return Velocity > Bands::Bands[(Low+High)/2].Velocity
+         ? StandardDragBandSearch<Bands, Low, (Low+High)/2>::Find(Velocity)
+         : StandardDragBandSearch<Bands, (Low+High)/2+1, High>::Find(Velocity);
+   }
+};
+
+template <class Bands, int Band>
+struct StandardDragBandSearch<Bands, Band, Band, true>
+{
+   static int Find(double) { return Band; }
+};
+
+// A built-in drag function, compiled in.  DragFunction must be G1, G2, G5, G6, G7 or G8.
+template <EDragFunction DragFunction>
+struct StandardDrag
+{
+   typedef StandardDragBands<DragFunction> Bands;
+
+   // As ::DragRetardationVelocity, for this drag function.
+   static double DragRetardationVelocity(double DragCoefficient, double Velocity)
+   {
+      if (!(Velocity > 0 && Velocity < DRAG_MAXVELOCITY))
+         return -1;
+
+      int i = StandardDragBandSearch<Bands, 0, Bands::Count-1>::Find(Velocity);
+      BALLISTICS_COUNT_BAND(i);
+      const DragBand& band = Bands::Bands[i];
+      return band.A * pow(Velocity, band.M) / DragCoefficient;
+   }
+
+   static double Retardation(Projectile& projectile, double Velocity)
+   {
+      return DragRetardationVelocity(projectile.DragCoefficient, Velocity);
+   }
+};
+
+// The drag as Projectile::DragRetardationVelocity finds it at run time: the projectile's
+// RetardationTable if it has one, and otherwise its drag function in the registry.
+struct RuntimeDrag
+{
+   static double Retardation(Projectile& projectile, double Velocity)
+   {
+      return projectile.DragRetardationVelocity(Velocity);
+   }
+};
+
+// The built-in drag function StandardDrag can stand in for on a projectile, or 0 if there is none:
+// the projectile has a RetardationTable, a registered drag model, or a built-in one SetDragModel replaced.
+inline EDragFunction StandardDragFunction(const Projectile& projectile)
+{
+   if (projectile.pRetardationTable || !IsStandardDragModel(projectile.DragFunction))
+      return (EDragFunction)0;
+
+   return projectile.DragFunction;
+}
+
+// Calls Loop.Run<Drag>() with the StandardDrag for the projectile, if there is one, or RuntimeDrag,
+// so a whole integration loop is compiled once per drag function and chosen once per flight.
+template <class Loop>
+typename Loop::Result DispatchDrag(const Projectile& projectile, Loop& loop)
+{
+   switch (StandardDragFunction(projectile))
+   {
+   case G1: return loop.template Run<StandardDrag<G1> >();
+   case G2: return loop.template Run<StandardDrag<G2> >();
+   case G5: return loop.template Run<StandardDrag<G5> >();
+   case G6: return loop.template Run<StandardDrag<G6> >();
+   case G7: return loop.template Run<StandardDrag<G7> >();
+   case G8: return loop.template Run<StandardDrag<G8> >();
+   default: return loop.template Run<RuntimeDrag>();
+   }
+}
+
+// The trapezoidal step of Projectile::Update, with the drag from Drag.  Without RecordRows, it produces
+// no ProjectilePath rows, and only ends the flight when the projectile gets too steep.
+template <class Drag, bool RecordRows = true>
+inline int TrapezoidalStep(Projectile& projectile, double &dt, double headwind_mile_hr, double crosswind_mile_hr)
+{
+   // feet per second
+   double vx_last = projectile.vx;
+   double vy_last = projectile.vy;
+
+   double v = sqrt(projectile.vx*projectile.vx+projectile.vy*projectile.vy);
+
+   // Compute acceleration using the drag function retardation
+   double dv = Drag::Retardation(projectile, v + headwind_mile_hr*5280.0/3600.0);
+   double dvx = -(projectile.vx/v) * dv;
+   double dvy = -(projectile.vy/v) * dv;
+
+   // Compute velocity, including the resolved gravity vectors.
+   projectile.vx += dt * dvx + dt * projectile.Gx;
+   projectile.vy += dt * dvy + dt * projectile.Gy;
+
+   if (RecordRows && projectile.x/3>=projectile.ProjectilePathCount*projectile.PathInterval)
+      projectile.RecordPathRow(projectile.x, projectile.y, projectile.t+dt, v, projectile.vx, projectile.vy, crosswind_mile_hr);
+
+   // Compute position based on average velocity.
+   projectile.x += dt * (projectile.vx+vx_last)/2;
+   projectile.y += dt * (projectile.vy+vy_last)/2;
+
+   dt = 0.5 / v;
+   BALLISTICS_COUNT(Steps);
+
+   if (fabs(projectile.vy) > fabs(3*projectile.vx))
+   {
+      BALLISTICS_COUNT(SteepExits);
+      return 0;
+   }
+
+   if (RecordRows && projectile.ProjectilePathCount >= projectile.PathRows)
+      return 0;
+
+   return 1;
+}
+
+// The trapezoidal trial shot of Projectile::ZeroTrialHeight, with the drag from Drag.
+template <class Drag>
+inline double TrapezoidalTrialHeight(Projectile& projectile, double Angle, double Range_feet)
+{
+   // Numerical Integration variables
+   double t = 0;
+   double dt = 1/projectile.MuzzleVelocity; // The solution accuracy generally doesn't suffer if its within a foot for each second of time.
+   double y = -projectile.SightHeightOverBore/12;
+   double x = 0;
+   double x_last = 0;
+   double y_last = y;
+
+   // State variables for the integration loop.
+   double v = 0;
+   double vx = projectile.MuzzleVelocity * cos(Angle);
+   double vy = projectile.MuzzleVelocity * sin(Angle); // velocity
+   double vx_last = 0;
+   double vy_last = 0; // Last frame's velocity, used for computing average velocity.
+   double dv = 0;
+   double dvx = 0;
+   double dvy = 0; // acceleration
+   double Gx = GRAVITY * sin(Angle);
+   double Gy = GRAVITY * cos(Angle); // Gravitational acceleration
+
+   // Stop as soon as x passes the range.
+   for (t = 0; x <= Range_feet; t = t + dt)
+   {
+      vy_last = vy;
+      vx_last = vx;
+      x_last = x;
+      y_last = y;
+
+      v = sqrt(vx*vx+vy*vy);
+      dt = 1/v;
+
+      // Compute acceleration using the drag function retardation
+      dv = Drag::Retardation(projectile, v);
+      dvx = -(vx/v) * dv;
+      dvy = -(vy/v) * dv;
+
+      // Compute velocity, including the resolved gravity vectors.
+      vx += dt * dvx + dt * Gx;
+      vy += dt * dvy + dt * Gy;
+
+      x += dt * (vx+vx_last)/2;
+      y += dt * (vy+vy_last)/2;
+      BALLISTICS_COUNT(Steps);
+
+      // Break early to save CPU time if we won't find a solution.
+      if (vy > 3 * vx)
+      {
+         BALLISTICS_COUNT(SteepExits);
+         return y;
+      }
+   }
+
+   // Interpolate the height at the exact range, so that it changes smoothly with the angle.
+   return y_last + (y-y_last) * (Range_feet-x_last)/(x-x_last);
+}
+
+// A Projectile with its drag function fixed at compile time.  Its Update takes trapezoidal steps with
+// StandardDrag<Function> inlined, for callers that step the projectile themselves; everything else,
+// including RK45 and RetardationTable steps, is Projectile's.
+//
+// Function must be G1, G2, G5, G6, G7 or G8, and the DragFunction member must stay set to it.
+// BasicProjectile<G7>::Update always uses the built-in G7 bands, even if SetDragModel replaced them.
+template <EDragFunction Function>
+class BasicProjectile : public Projectile
+{
+public:
+   BasicProjectile(double DragCoefficient, double MuzzleVelocity, double SightHeightOverBore)
+      : Projectile(DragCoefficient, Function, MuzzleVelocity, SightHeightOverBore)
+   {
+   }
+
+   // As Projectile::Update.
+   int Update(double &dt, double headwind_mile_hr, double crosswind_mile_hr)
+   {
+      if (Integrator == RK45 || pRetardationTable)
+         return Projectile::Update(dt, headwind_mile_hr, crosswind_mile_hr);
+
+      return TrapezoidalStep<StandardDrag<Function> >(*this, dt, headwind_mile_hr, crosswind_mile_hr);
+   }
+};
+
+#endif
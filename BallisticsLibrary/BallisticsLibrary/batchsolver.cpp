@@ -0,0 +1,61 @@
+#include "batchsolver.h"
+#include "atmosphere.h"
+
+BatchSolver::BatchSolver(int ThreadCount)
+   : Pool(ThreadCount)
+{
+   for (int i = 0; i < Pool.ThreadCount(); i++)
+      Scratch.push_back(Projectile(1, G1, 1, 0));
+}
+
+void BatchSolver::Solve(const std::vector<SolutionRequest>& Requests, std::vector<SolutionResult>& Results)
+{
+   Results.resize(Requests.size());
+
+   SolveContext context = { this, &Requests, &Results };
+   Pool.Run((int)Requests.size(), SolveTask, &context);
+}
+
+void BatchSolver::SolveTask(int Index, int Worker, void* Context)
+{
+   SolveContext* context = (SolveContext*)Context;
+   SolveOne((*context->pRequests)[Index], context->Solver->Scratch[Worker], (*context->pResults)[Index]);
+}
+
+void BatchSolver::SolveOne(const SolutionRequest& Request, Projectile& Scratch, SolutionResult& Result)
+{
+   SolveZero(Request, Scratch, Result);
+   SolveZeroed(Request, Scratch, Result);
+}
+
+// Sets up the projectile of a request, with the given (atmosphere corrected) drag coefficient.
+static void SetUpProjectile(const SolutionRequest& Request, double DragCoefficient, Projectile& projectile)
+{
+   projectile.DragFunction = Request.DragFunction;
+   projectile.DragCoefficient = DragCoefficient;
+   projectile.MuzzleVelocity = Request.MuzzleVelocity;
+   projectile.SightHeightOverBore = Request.SightHeightOverBore;
+   projectile.Integrator = Request.Integrator;
+   projectile.pRetardationTable = NULL;
+}
+
+void BatchSolver::SolveZero(const SolutionRequest& Request, Projectile& Scratch, SolutionResult& Result)
+{
+   Atmosphere weather = { Request.Altitude_feet, Request.Barometer_hg, Request.Temperature_f, Request.RelativeHumidity };
+   Result.DragCoefficient = Request.DragCoefficient * AtmosphericCorrection(weather);
+
+   Projectile& projectile = Scratch;
+   SetUpProjectile(Request, Result.DragCoefficient, projectile);
+   Result.SightToBoreAngle = projectile.CalculateSightToBoreAngle(Request.ZeroRange_yard, Request.yIntercept_inch);
+}
+
+void BatchSolver::SolveZeroed(const SolutionRequest& Request, Projectile& Scratch, SolutionResult& Result)
+{
+   Projectile& projectile = Scratch;
+   SetUpProjectile(Request, Result.DragCoefficient, projectile);
+   projectile.Fire(Request.BoreAngle, Result.SightToBoreAngle);
+
+   Result.Table.resize(PathTableRows(Request.MaxRange_yard, Request.RangeStep_yard) * PathColumnCount(Request.Columns));
+   Result.RowCount = SolveTable(Request.WindSpeed_mile_hr, Request.WindAngle, projectile, Request.RangeStep_yard, Request.MaxRange_yard, Request.Columns, Result.Table.data());
+   Result.Table.resize(Result.RowCount * PathColumnCount(Request.Columns));
+}
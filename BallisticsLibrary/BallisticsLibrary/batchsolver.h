@@ -0,0 +1,93 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _BATCHSOLVER_
+#define _BATCHSOLVER_
+
+#include "ballistics.h"
+#include "threadpool.h"
+
+// One independent firing solution: a projectile, the atmosphere, the zero, the shot, and the table wanted.
+struct SolutionRequest
+{
+   EDragFunction DragFunction;
+   double DragCoefficient;       // for standard conditions; corrected for the atmosphere below
+   double MuzzleVelocity;        // in ft/s
+   double SightHeightOverBore;   // in inches
+   EIntegrator Integrator;
+
+   double Altitude_feet;
+   double Barometer_hg;
+   double Temperature_f;
+   double RelativeHumidity;
+
+   double ZeroRange_yard;
+   double yIntercept_inch;
+
+   double BoreAngle;             // the uphill or downhill shooting angle, in degrees
+   double WindSpeed_mile_hr;
+   double WindAngle;
+
+   double RangeStep_yard;        // the table, as for SolveTable
+   double MaxRange_yard;
+   int Columns;
+};
+
+// The solution to one SolutionRequest.
+struct SolutionResult
+{
+   double DragCoefficient;       // corrected for the atmosphere
+   double SightToBoreAngle;      // in degrees
+   int RowCount;
+   std::vector<double> Table;    // RowCount rows of the requested columns, packed as by SolveTable
+};
+
+// Solves batches of independent requests across a work-stealing ThreadPool.
+//
+// Each request runs DragCoefficientAtmosphericCorrection, CalculateSightToBoreAngle, Fire and SolveTable
+// on a Projectile that belongs to the worker thread, reused from one request to the next.  Solving shares
+// nothing between requests: a Projectile keeps all of its state in itself, the free functions keep none,
+// and the only global, the drag model registry (see drag.h), is only read.  So the results do not depend
+// on the thread count or the order the requests run in, provided no drag models are registered meanwhile.
+//
+// Solve may be called from several threads at once on the same BatchSolver.  Each call's requests and
+// results travel with its own tasks, and the pool runs the calls one after the other, so they do not
+// overlap on the worker threads' projectiles.  SolveOne, SolveZero and SolveZeroed may run concurrently
+// with each other and with Solve, each with its own Scratch projectile.
+class BatchSolver
+{
+public:
+   BatchSolver(int ThreadCount = 0);
+   /* Arguments:
+         ThreadCount:  The number of worker threads, or 0 for one per hardware thread.
+   */
+
+   // Solves every request and puts its result at the same index in Results, resizing it to match.
+   // Results' tables keep their memory from one call to the next.
+   void Solve(const std::vector<SolutionRequest>& Requests, std::vector<SolutionResult>& Results);
+
+   // Solves one request on the calling thread, with the given scratch projectile.
+   static void SolveOne(const SolutionRequest& Request, Projectile& Scratch, SolutionResult& Result);
+
+   // The two halves of SolveOne.  SolveZero fills in Result's DragCoefficient and SightToBoreAngle;
+   // SolveZeroed takes them from Result, and fills in the table.
+   static void SolveZero(const SolutionRequest& Request, Projectile& Scratch, SolutionResult& Result);
+   static void SolveZeroed(const SolutionRequest& Request, Projectile& Scratch, SolutionResult& Result);
+
+private:
+   ThreadPool Pool;
+   std::vector<Projectile> Scratch; // one per worker thread
+
+   // What the tasks of one Solve call work on.  It lives on the caller's stack, for the duration of the call.
+   struct SolveContext
+   {
+      BatchSolver* Solver;
+      const std::vector<SolutionRequest>* pRequests;
+      std::vector<SolutionResult>* pResults;
+   };
+
+   static void SolveTask(int Index, int Worker, void* Context);
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "ballistics.h"
+
+int main()
+{
+   EDragFunction DragFunction = G1;
+   double initialVelocity = 2650; // Initial velocity, in ft/s
+   double ballisticCoefficient = 0.465; // The ballistic coefficient for the projectile.
+   double sightHeightOverBore = 1.6; // The Sight height over bore, in inches.
+
+   Projectile projectile(ballisticCoefficient,DragFunction,initialVelocity,sightHeightOverBore);
+
+   double Altitude = 0; // The altitude above sea level in feet.  Standard altitude is 0 feet above sea level.
+   double Barometer = 29.59; // The barometric pressure in inches of mercury (in Hg).
+   double Temperature = 59; // The temperature in Fahrenheit.  Standard temperature is 59 degrees.
+   double RelativeHumidity = 0.78; // The relative humidity fraction.  Ranges from 0.00 to 1.00, with 0.50 being 50% relative humidity.
+   // If we wish to use the weather correction features, we need to 
+   // Correct the BC for any weather conditions.  If we want standard conditions,
+   // then we can just leave this commented out.
+   ballisticCoefficient = projectile.DragCoefficientAtmosphericCorrection(Altitude, Barometer, Temperature, RelativeHumidity);
+
+   double zeroRange = 200; // The zero range of the rifle, in yards.
+   double yIntercept = 0; // The height, in inches, you wish for the projectile to be when it crosses ZeroRange yards.
+   // First find the angle of the bore relative to the sighting system.
+   // We call this the "zero angle", since it is the angle required to 
+   // achieve a zero at a particular yardage.  This value isn't very useful
+   // to us, but is required for making a full ballistic solution.
+   // It is left here to allow for zero-ing at altitudes (bc) different from the
+   // final solution, or to allow for zero's other than 0" (ex: 3" high at 100 yards)
+   double sightToBoreAngle = projectile.CalculateSightToBoreAngle(zeroRange,yIntercept);
+
+   double boreAngle = 0; // The shooting angle (uphill / downhill), in degrees.
+   projectile.Fire(boreAngle,sightToBoreAngle);
+
+   // Now we have everything needed to generate a full solution.
+   // So we do.  The solution is stored in the pointer "sln" passed as the last argument.
+   // k has the number of yards the solution is valid for, also the number of rows in the solution.
+   
+   // We only need the range, path and time, out to 1000 yards in 10 yard increments.
+   double maxRange = 1000;
+   double rangeStep = 10;
+   int columns = PATH_RANGE | PATH_PATH | PATH_TIME;
+   double* table = new double[PathTableRows(maxRange, rangeStep) * PathColumnCount(columns)];
+
+   double windspeed = 0; // The wind speed in miles per hour.
+   double windangle = 0; // The wind angle (0=headwind, 90=right to left, 180=tailwind, 270/-90=left to right)
+   int rowCount = SolveTable(windspeed,windangle,projectile,rangeStep,maxRange,columns,table);
+
+   // Now print a simple chart of X / Y trajectory spaced at 10yd increments
+   for (int s = 0; s < rowCount; s++)
+   {
+      printf("\nX: %.0f     Y: %.2f		t: %.2f", table[s*3], table[s*3+1], table[s*3+2]);
+   }
+
+   delete[] table;
+   printf("\n");
+
+   return 0;
+}
@@ -0,0 +1,164 @@
+#include "dispersion.h"
+#include "atmosphere.h"
+
+#include <string.h>
+
+#define DISPERSION_BLOCK 256 // samples per task, and per partial sum
+
+DispersionSolver::DispersionSolver(int ThreadCount)
+   : Pool(ThreadCount)
+{
+   for (int i = 0; i < Pool.ThreadCount(); i++)
+      Scratch.push_back(Projectile(1, G1, 1, 0));
+}
+
+// The 8 standard normal numbers of a sample: two Philox blocks, through the Box-Muller transform.
+static void SampleNormals(unsigned long long Seed, long long Index, double Normals[8])
+{
+   unsigned key[2] = { (unsigned)Seed, (unsigned)(Seed >> 32) };
+   for (int block = 0; block < 2; block++)
+   {
+      unsigned counter[4] = { (unsigned)Index, (unsigned)((unsigned long long)Index >> 32), (unsigned)block, 0 };
+      unsigned bits[4];
+      Philox4x32(counter, key, bits);
+
+      for (int i = 0; i < 4; i += 2)
+      {
+         // Uniform in (0, 1), never 0, so the log is finite.
+         double u1 = (bits[i] + 0.5) / 4294967296.0;
+         double u2 = (bits[i+1] + 0.5) / 4294967296.0;
+         double r = sqrt(-2*log(u1));
+         Normals[block*4+i] = r * cos(2*M_PI*u2);
+         Normals[block*4+i+1] = r * sin(2*M_PI*u2);
+      }
+   }
+}
+
+// Sets up and fires a projectile with the given inputs.
+static void FireSample(const DispersionRequest& Request, double DragCoefficient, double MuzzleVelocity, double SightToBoreAngle, Projectile& projectile)
+{
+   projectile.DragFunction = Request.DragFunction;
+   projectile.DragCoefficient = DragCoefficient;
+   projectile.MuzzleVelocity = MuzzleVelocity;
+   projectile.SightHeightOverBore = Request.SightHeightOverBore;
+   projectile.Integrator = Request.Integrator;
+   projectile.pRetardationTable = NULL;
+   projectile.PathColumns = PATH_RANGE | PATH_PATH | PATH_WINDAGE;
+   projectile.Fire(Request.BoreAngle, SightToBoreAngle);
+}
+
+DispersionImpact DispersionSolver::SolveSample(const DispersionRequest& Request, long long Index, const DispersionImpact& Hold,
+                                               double SightToBoreAngle, double AtmosphericCorrection, Projectile& Scratch)
+{
+   double n[8];
+   SampleNormals(Request.Seed, Index, n);
+
+   double muzzleVelocity = Request.MuzzleVelocity.Mean + n[0]*Request.MuzzleVelocity.Sigma;
+   double dragCoefficient = Request.DragCoefficient.Mean + n[1]*Request.DragCoefficient.Sigma;
+   double windSpeed = Request.WindSpeed_mile_hr.Mean + n[2]*Request.WindSpeed_mile_hr.Sigma;
+   double windAngle = Request.WindAngle.Mean + n[3]*Request.WindAngle.Sigma;
+   double range = Request.Range_yard.Mean + n[4]*Request.Range_yard.Sigma;
+
+   DispersionImpact impact = { 0, 0, false };
+   if (!(muzzleVelocity > 0 && dragCoefficient > 0 && range > 0))
+      return impact;
+
+   FireSample(Request, dragCoefficient*AtmosphericCorrection, muzzleVelocity, SightToBoreAngle, Scratch);
+   ProjectilePath row;
+   if (!SolveRanges(windSpeed, windAngle, Scratch, &range, 1, &row))
+      return impact;
+
+   // The hold is an angle, so it scales with the true range; so does the aiming error.
+   double scale = range / Request.Range_yard.Mean;
+   double aim = tan(MOAtoRad(Request.Aim_moa)) * range*36;
+   impact.Horizontal = row.Windage - Hold.Horizontal*scale + n[5]*aim;
+   impact.Vertical = row.Path - Hold.Vertical*scale + n[6]*aim;
+   impact.Reached = true;
+   return impact;
+}
+
+void DispersionSolver::SolveTask(int Index, int Worker, void* Context)
+{
+   SolveContext* context = (SolveContext*)Context;
+   const DispersionRequest& request = *context->pRequest;
+   Block& block = context->Blocks[Index];
+   memset(&block, 0, sizeof(block));
+
+   long long end = (long long)(Index+1) * DISPERSION_BLOCK;
+   if (end > request.Count)
+      end = request.Count;
+
+   for (long long i = (long long)Index * DISPERSION_BLOCK; i < end; i++)
+   {
+      DispersionImpact impact = SolveSample(request, i, context->Hold, context->SightToBoreAngle, context->AtmosphericCorrection, context->Solver->Scratch[Worker]);
+      if (!impact.Reached)
+         continue;
+
+      block.Reached++;
+      if (fabs(impact.Horizontal) <= request.TargetWidth_inch/2 && fabs(impact.Vertical) <= request.TargetHeight_inch/2)
+         block.Hits++;
+
+      block.Sum[0] += impact.Horizontal;
+      block.Sum[1] += impact.Vertical;
+      block.Products[0] += impact.Horizontal*impact.Horizontal;
+      block.Products[1] += impact.Horizontal*impact.Vertical;
+      block.Products[2] += impact.Vertical*impact.Vertical;
+   }
+}
+
+void DispersionSolver::Solve(const DispersionRequest& Request, DispersionResult& Result)
+{
+   memset(&Result, 0, sizeof(Result));
+
+   SolveContext context;
+   context.Solver = this;
+   context.pRequest = &Request;
+
+   // Zero the sight and find the hold on the mean inputs, as the shooter would, on this thread's own
+   // projectile: the workers' may be busy with another call.
+   Projectile projectile(1, G1, 1, 0);
+   Atmosphere weather = { Request.Altitude_feet, Request.Barometer_hg, Request.Temperature_f, Request.RelativeHumidity };
+   context.AtmosphericCorrection = AtmosphericCorrection(weather);
+   FireSample(Request, Request.DragCoefficient.Mean*context.AtmosphericCorrection, Request.MuzzleVelocity.Mean, 0, projectile);
+   context.SightToBoreAngle = projectile.CalculateSightToBoreAngle(Request.ZeroRange_yard, Request.yIntercept_inch);
+   Result.SightToBoreAngle = context.SightToBoreAngle;
+
+   FireSample(Request, projectile.DragCoefficient, Request.MuzzleVelocity.Mean, context.SightToBoreAngle, projectile);
+   ProjectilePath row;
+   DispersionImpact& hold = context.Hold;
+   hold.Reached = SolveRanges(Request.WindSpeed_mile_hr.Mean, Request.WindAngle.Mean, projectile, &Request.Range_yard.Mean, 1, &row) == 1;
+   hold.Horizontal = row.Windage;
+   hold.Vertical = row.Path;
+   if (!hold.Reached || Request.Count <= 0)
+      return;
+
+   int blocks = (int)((Request.Count + DISPERSION_BLOCK-1) / DISPERSION_BLOCK);
+   context.Blocks.resize(blocks);
+   Pool.Run(blocks, SolveTask, &context);
+
+   double sum[2] = { 0, 0 }, products[3] = { 0, 0, 0 };
+   for (int b = 0; b < blocks; b++)
+   {
+      Result.Reached += context.Blocks[b].Reached;
+      Result.Hits += context.Blocks[b].Hits;
+      for (int i = 0; i < 2; i++)
+         sum[i] += context.Blocks[b].Sum[i];
+      for (int i = 0; i < 3; i++)
+         products[i] += context.Blocks[b].Products[i];
+   }
+
+   Result.HitProbability = (double)Result.Hits / Request.Count;
+   if (Result.Reached == 0)
+      return;
+
+   double n = Result.Reached;
+   Result.MeanHorizontal = sum[0]/n;
+   Result.MeanVertical = sum[1]/n;
+   if (Result.Reached > 1)
+   {
+      Result.Covariance[0][0] = (products[0] - n*Result.MeanHorizontal*Result.MeanHorizontal) / (n-1);
+      Result.Covariance[0][1] = (products[1] - n*Result.MeanHorizontal*Result.MeanVertical) / (n-1);
+      Result.Covariance[1][1] = (products[2] - n*Result.MeanVertical*Result.MeanVertical) / (n-1);
+      Result.Covariance[1][0] = Result.Covariance[0][1];
+   }
+}
@@ -0,0 +1,160 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _DISPERSION_
+#define _DISPERSION_
+
+#include <vector>
+
+#include "ballistics.h"
+#include "threadpool.h"
+
+// Philox4x32-10, the counter based random number generator of Salmon et al., "Parallel random numbers:
+// as easy as 1, 2, 3" (SC11).  Each 128 bit counter gives 4 independent 32 bit numbers under a key, so
+// a sample's random inputs follow from its index alone, whichever thread draws them, in whatever order.
+inline void Philox4x32(const unsigned Counter[4], const unsigned Key[2], unsigned Out[4])
+{
+   unsigned c0 = Counter[0], c1 = Counter[1], c2 = Counter[2], c3 = Counter[3];
+   unsigned k0 = Key[0], k1 = Key[1];
+
+   for (int round = 0; round < 10; round++)
+   {
+      if (round > 0)
+      {
+         k0 += 0x9E3779B9;
+         k1 += 0xBB67AE85;
+      }
+
+      unsigned long long p0 = (unsigned long long)0xD2511F53 * c0;
+      unsigned long long p1 = (unsigned long long)0xCD9E8D57 * c2;
+      c0 = (unsigned)(p1 >> 32) ^ c1 ^ k0;
+      c2 = (unsigned)(p0 >> 32) ^ c3 ^ k1;
+      c1 = (unsigned)p1;
+      c3 = (unsigned)p0;
+   }
+
+   Out[0] = c0;
+   Out[1] = c1;
+   Out[2] = c2;
+   Out[3] = c3;
+}
+
+// A normally distributed input: its mean, and its standard deviation (0 for a fixed value).
+struct DispersionInput
+{
+   double Mean;
+   double Sigma;
+};
+
+// A shot at a target, with uncertain inputs.
+//
+// The sight is zeroed once, on the mean inputs, and the shooter holds off for the mean inputs at the
+// mean range, so the mean trajectory hits the center of the target.  Each sample then draws its muzzle
+// velocity, drag coefficient, wind and true range, flies to that range, and adds an aiming error.
+struct DispersionRequest
+{
+   EDragFunction DragFunction;
+   EIntegrator Integrator;
+   DispersionInput DragCoefficient;   // for standard conditions; corrected for the atmosphere below
+   DispersionInput MuzzleVelocity;    // in ft/s
+   double SightHeightOverBore;        // in inches
+
+   double Altitude_feet;
+   double Barometer_hg;
+   double Temperature_f;
+   double RelativeHumidity;
+
+   double ZeroRange_yard;
+   double yIntercept_inch;
+
+   double BoreAngle;                  // the uphill or downhill shooting angle, in degrees
+   DispersionInput WindSpeed_mile_hr;
+   DispersionInput WindAngle;         // in degrees
+   DispersionInput Range_yard;        // the range to the target; its mean is the range held for
+   double Aim_moa;                    // the standard deviation of the aim, each way, in MOA: the rifle's and the shooter's precision
+
+   double TargetWidth_inch;           // the target, centered on the point of aim
+   double TargetHeight_inch;
+
+   int Count;                         // the number of samples
+   unsigned long long Seed;           // the Philox key: the same seed gives the same samples
+};
+
+// Where the samples hit, relative to the point of aim, in inches at the target.  Horizontal is in the
+// direction of ProjectilePath::Windage; Vertical is up.
+struct DispersionResult
+{
+   double SightToBoreAngle;     // the zero, in degrees
+   int Reached;                 // the samples that reached their range (the rest count as misses)
+   int Hits;                    // the samples that hit the target
+   double HitProbability;       // Hits / Count
+   double MeanHorizontal;       // the mean point of impact of the samples that reached their range
+   double MeanVertical;
+   double Covariance[2][2];     // of their impacts: horizontal and vertical, in square inches
+};
+
+// A sample's point of impact.
+struct DispersionImpact
+{
+   double Horizontal;
+   double Vertical;
+   bool Reached;
+};
+
+// Runs Monte Carlo dispersion studies across a work-stealing ThreadPool.
+//
+// Each sample flies only to its target range, with SolveRanges, and computes only the path and windage.
+// The samples are split into fixed blocks, each summed in order, and the blocks are summed in order, so
+// the result depends only on the request, not on the thread count or the order the blocks run in.
+//
+// Solve may be called from several threads at once on the same DispersionSolver, as BatchSolver::Solve
+// may: each call's request, zero, hold and sums travel with its own tasks, and the pool runs the calls
+// one after the other.  SolveSample may run concurrently with anything, with its own Scratch projectile.
+class DispersionSolver
+{
+public:
+   DispersionSolver(int ThreadCount = 0);
+   /* Arguments:
+         ThreadCount:  The number of worker threads, or 0 for one per hardware thread.
+   */
+
+   // Flies Request.Count samples, and sums up where they hit.
+   void Solve(const DispersionRequest& Request, DispersionResult& Result);
+
+   // Solves sample Index of a request on the calling thread, with the given scratch projectile.  Hold is
+   // the impact of the mean inputs at the mean range, without aiming error, which the shooter holds off for;
+   // SightToBoreAngle is the request's zero, and AtmosphericCorrection the factor its drag coefficient gets.
+   static DispersionImpact SolveSample(const DispersionRequest& Request, long long Index, const DispersionImpact& Hold,
+                                       double SightToBoreAngle, double AtmosphericCorrection, Projectile& Scratch);
+
+private:
+   struct Block
+   {
+      int Reached;
+      int Hits;
+      double Sum[2];
+      double Products[3];   // horizontal^2, horizontal*vertical, vertical^2
+   };
+
+   // What the tasks of one Solve call work on.  It lives on the caller's stack, for the duration of the call.
+   struct SolveContext
+   {
+      DispersionSolver* Solver;
+      const DispersionRequest* pRequest;
+      DispersionImpact Hold;
+      double SightToBoreAngle;
+      double AtmosphericCorrection;
+      std::vector<Block> Blocks;
+   };
+
+   ThreadPool Pool;
+   std::vector<Projectile> Scratch; // one per worker thread
+
+   static void SolveTask(int Index, int Worker, void* Context);
+
+   DispersionSolver(const DispersionSolver&) = delete;
+   DispersionSolver& operator=(const DispersionSolver&) = delete;
+};
+
+#endif
@@ -0,0 +1,519 @@
+#include "drag.h"
+#include "dragbands.h"
+#include "instrument.h"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// Retardation, in ft/s per second, of a projectile with a ballistic coefficient of 1 lb/in^2,
+// per unit of Cd and per (ft/s)^2, in the standard atmosphere.
+static const double CdToRetardation = 2.08551e-04;
+
+// Fills in a model's bands, float bands and grid from bands that SetDragModel has validated.
+static void FillDragModel(DragModel& model, const DragBand* Bands, int BandCount)
+{
+   model.BandCount = 0;
+
+   for (int i = 0; i < DRAG_MAXBANDS; i++)
+   {
+      if (i < BandCount)
+      {
+         model.Bands[i] = Bands[i];
+      }
+      else
+      {
+         model.Bands[i].Velocity = 0;
+         model.Bands[i].A = 0;
+         model.Bands[i].M = 0;
+      }
+      model.FloatBands[i][0] = (float)model.Bands[i].Velocity;
+      model.FloatBands[i][1] = (float)model.Bands[i].A;
+      model.FloatBands[i][2] = (float)model.Bands[i].M;
+   }
+
+   // Grid[j] is the first band below j+1 ft/s.
+   int band = 0;
+   for (int j = DRAG_MAXVELOCITY-1; j >= 0; j--)
+   {
+      while (model.Bands[band].Velocity >= j+1)
+         band++;
+      model.Grid[j] = (unsigned char)band;
+   }
+   for (int j = DRAG_MAXVELOCITY; j < DRAG_MAXVELOCITY+3; j++)
+      model.Grid[j] = 0;
+
+   model.BandCount = BandCount;
+}
+
+// The registry, with the built-in drag functions compiled in.
+struct DragRegistry
+{
+   DragModel Models[DRAG_MAXMODELS];
+   bool Standard[DRAG_MAXMODELS]; // still holds its built-in bands, the ones StandardDrag compiles in
+
+   template <EDragFunction DragFunction>
+   void SetStandardDragModel()
+   {
+      FillDragModel(Models[DragFunction], StandardDragBands<DragFunction>::Bands, StandardDragBands<DragFunction>::Count);
+      Standard[DragFunction] = true;
+   }
+
+   DragRegistry()
+      : Models(), Standard()
+   {
+      SetStandardDragModel<G1>();
+      SetStandardDragModel<G2>();
+      SetStandardDragModel<G5>();
+      SetStandardDragModel<G6>();
+      SetStandardDragModel<G7>();
+      SetStandardDragModel<G8>();
+   }
+};
+
+// The registry is built on first use, not at load time, so that static initializers in other translation
+// units, which may run first, find the built-in drag functions too.
+static DragRegistry& Registry()
+{
+   static DragRegistry registry;
+   return registry;
+}
+
+const DragModel* GetDragModel(EDragFunction DragFunction)
+{
+   if (DragFunction < G1 || DragFunction > GCustomLast)
+      return NULL;
+
+   const DragModel* model = &Registry().Models[DragFunction];
+   return model->BandCount ? model : NULL;
+}
+
+int IsStandardDragModel(EDragFunction DragFunction)
+{
+   if (DragFunction < G1 || DragFunction > GCustomLast)
+      return 0;
+
+   return Registry().Standard[DragFunction];
+}
+
+int SetDragModel(EDragFunction DragFunction, const DragBand* Bands, int BandCount)
+{
+   if (DragFunction < G1 || DragFunction > GCustomLast)
+      return 0;
+   if (BandCount < 1 || BandCount > DRAG_MAXBANDS || Bands[BandCount-1].Velocity != 0)
+      return 0;
+   for (int i = 1; i < BandCount; i++)
+   {
+      // At most one band edge per 1 ft/s grid cell.
+      if (!(Bands[i-1].Velocity - Bands[i].Velocity >= 1))
+         return 0;
+   }
+
+   DragRegistry& registry = Registry();
+   registry.Standard[DragFunction] = false;
+   FillDragModel(registry.Models[DragFunction], Bands, BandCount);
+   return 1;
+}
+
+int DragBandsFromCdMach(const double* Mach, const double* Cd, int Count, DragBand* Bands)
+{
+   if (Count < 2 || Count > DRAG_MAXBANDS+1)
+      return 0;
+
+   // One band per segment, highest velocity first.
+   for (int k = 0; k < Count-1; k++)
+   {
+      double v0 = Mach[k] * DRAG_SPEEDOFSOUND;
+      double v1 = Mach[k+1] * DRAG_SPEEDOFSOUND;
+      if (!(v1 - v0 >= 1) || !(Cd[k] > 0) || !(Cd[k+1] > 0) || v0 < 0)
+         return 0;
+
+      DragBand& band = Bands[Count-2-k];
+      double r1 = CdToRetardation * Cd[k+1] * v1 * v1;
+      if (v0 == 0)
+      {
+         // A Mach 0 point: hold Cd constant down to 0 ft/s.
+         band.M = 2;
+      }
+      else
+      {
+         double r0 = CdToRetardation * Cd[k] * v0 * v0;
+         band.M = log(r1/r0) / log(v1/v0);
+      }
+      band.A = r1 / pow(v1, band.M);
+      band.Velocity = (k == 0) ? 0 : v0;
+   }
+
+   return Count-1;
+}
+
+EDragFunction RegisterDragModel(const double* Mach, const double* Cd, int Count)
+{
+   DragBand bands[DRAG_MAXBANDS];
+   int bandCount = DragBandsFromCdMach(Mach, Cd, Count, bands);
+   if (!bandCount)
+      return (EDragFunction)0;
+
+   for (int id = GCustom; id <= GCustomLast; id++)
+   {
+      if (Registry().Models[id].BandCount == 0)
+      {
+         return SetDragModel((EDragFunction)id, bands, bandCount) ? (EDragFunction)id : (EDragFunction)0;
+      }
+   }
+
+   return (EDragFunction)0;
+}
+
+double DragRetardationVelocity(EDragFunction DragFunction, double DragCoefficient, double Velocity)
+{
+   double vp = Velocity;
+   const DragModel* model = GetDragModel(DragFunction);
+
+   if (model && vp > 0 && vp < DRAG_MAXVELOCITY)
+   {
+      const DragBand& band = FindDragBand(model, vp);
+      BALLISTICS_COUNT_BAND(&band - model->Bands);
+      return band.A * pow(vp, band.M) / DragCoefficient;
+   }
+   else
+   {
+      return -1;
+   }
+}
+
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+// 1/21, 1/19, ... 1/3, 1: the atanh series used by the vector logs.
+static const double LogSeries[11] = { 1.0/21, 1.0/19, 1.0/17, 1.0/15, 1.0/13, 1.0/11, 1.0/9, 1.0/7, 1.0/5, 1.0/3, 1.0 };
+
+// 1/13!, 1/12!, ... 1/1!, 1/0!: the Taylor series used by the vector exps.
+static const double ExpSeries[14] =
+{
+   1.0/6227020800.0, 1.0/479001600.0, 1.0/39916800.0, 1.0/3628800.0, 1.0/362880.0, 1.0/40320.0, 1.0/5040.0,
+   1.0/720.0, 1.0/120.0, 1.0/24.0, 1.0/6.0, 1.0/2.0, 1.0, 1.0
+};
+
+// 1/11, 1/9, ... 1/3, 1: the atanh series used by the float vector logs, enough for float.
+static const float LogSeriesF[6] = { 1.0f/11, 1.0f/9, 1.0f/7, 1.0f/5, 1.0f/3, 1.0f };
+
+// 1/8!, 1/7!, ... 1/1!, 1/0!: the Taylor series used by the float vector exps.
+static const float ExpSeriesF[9] = { 1.0f/40320, 1.0f/5040, 1.0f/720, 1.0f/120, 1.0f/24, 1.0f/6, 1.0f/2, 1.0f, 1.0f };
+
+#endif
+
+#if defined(__AVX2__)
+
+// log(v) for positive, normal v: v = m * 2^e with m in [sqrt(1/2), sqrt(2)),
+// log(m) = 2*atanh(s) with s = (m-1)/(m+1), |s| < 0.172, summed to s^21.
+static inline __m256d Log4(__m256d v)
+{
+   __m256i bits = _mm256_castpd_si256(v);
+   __m256i biased = _mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x4330000000000000LL));
+   __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(biased), _mm256_set1_pd(4503599627370496.0 + 1023.0));
+   __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)), _mm256_set1_epi64x(0x3FF0000000000000LL)));
+
+   __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(1.4142135623730951), _CMP_GT_OQ);
+   m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+   e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+
+   __m256d s = _mm256_div_pd(_mm256_sub_pd(m, _mm256_set1_pd(1.0)), _mm256_add_pd(m, _mm256_set1_pd(1.0)));
+   __m256d z = _mm256_mul_pd(s, s);
+   __m256d p = _mm256_set1_pd(LogSeries[0]);
+   for (int k = 1; k < 11; k++)
+      p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(LogSeries[k]));
+
+   return _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(0.69314718055994530942)), _mm256_mul_pd(_mm256_add_pd(s, s), p));
+}
+
+// exp(x) for |x| < 700: x = n*log(2) + r with |r| <= log(2)/2, exp(r) summed to r^13, scaled by 2^n.
+static inline __m256d Exp4(__m256d x)
+{
+   x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-700.0)), _mm256_set1_pd(700.0));
+   __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634074)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+   __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(6.93145751953125e-1)));
+   r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(1.42860682030941723212e-6)));
+
+   __m256d p = _mm256_set1_pd(ExpSeries[0]);
+   for (int k = 1; k < 14; k++)
+      p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(ExpSeries[k]));
+
+   __m256i scale = _mm256_slli_epi64(_mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(4503599627370496.0 + 1023.0))), 52);
+   return _mm256_mul_pd(p, _mm256_castsi256_pd(scale));
+}
+
+static inline __m256d DragRetardationVelocity4(const DragModel* model, __m256d bc, __m256d v)
+{
+   __m256d valid = _mm256_and_pd(_mm256_cmp_pd(v, _mm256_setzero_pd(), _CMP_GT_OQ), _mm256_cmp_pd(v, _mm256_set1_pd(DRAG_MAXVELOCITY), _CMP_LT_OQ));
+   v = _mm256_blendv_pd(_mm256_set1_pd(1.0), v, valid);
+
+   // FindDragBand in each lane: gather the grid byte (as the low byte of a 4 byte read),
+   // then step to the next band where v is not above the band's Velocity.
+   // Band indices are kept times 3, the DragBand stride in doubles.
+   __m128i cell = _mm256_cvttpd_epi32(v);
+   __m128i band = _mm_and_si128(_mm_i32gather_epi32((const int*)model->Grid, cell, 1), _mm_set1_epi32(0xFF));
+   band = _mm_mullo_epi32(band, _mm_set1_epi32(3));
+   __m256d threshold = _mm256_i32gather_pd(&model->Bands[0].Velocity, band, 8);
+   __m256d below = _mm256_cmp_pd(v, threshold, _CMP_LE_OQ);
+   band = _mm_add_epi32(band, _mm256_cvttpd_epi32(_mm256_and_pd(below, _mm256_set1_pd(3.0))));
+
+   __m256d A = _mm256_i32gather_pd(&model->Bands[0].A, band, 8);
+   __m256d M = _mm256_i32gather_pd(&model->Bands[0].M, band, 8);
+
+   __m256d val = _mm256_div_pd(_mm256_mul_pd(A, Exp4(_mm256_mul_pd(M, Log4(v)))), bc);
+   return _mm256_blendv_pd(_mm256_set1_pd(-1.0), val, valid);
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+// Log4, in float: v = m * 2^e with m in [sqrt(1/2), sqrt(2)), log(m) summed to s^11.
+static inline __m256 LogF8(__m256 v)
+{
+   __m256i bits = _mm256_castps_si256(v);
+   __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+   __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+
+   __m256 big = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+   m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), big);
+   e = _mm256_add_ps(e, _mm256_and_ps(big, _mm256_set1_ps(1.0f)));
+
+   __m256 s = _mm256_div_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)), _mm256_add_ps(m, _mm256_set1_ps(1.0f)));
+   __m256 z = _mm256_mul_ps(s, s);
+   __m256 p = _mm256_set1_ps(LogSeriesF[0]);
+   for (int k = 1; k < 6; k++)
+      p = _mm256_add_ps(_mm256_mul_ps(p, z), _mm256_set1_ps(LogSeriesF[k]));
+
+   return _mm256_add_ps(_mm256_mul_ps(e, _mm256_set1_ps(0.693147181f)), _mm256_mul_ps(_mm256_add_ps(s, s), p));
+}
+
+// Exp4, in float, for |x| < 87: exp(r) summed to r^8.
+static inline __m256 ExpF8(__m256 x)
+{
+   x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.0f)), _mm256_set1_ps(87.0f));
+   __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+   __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f)));
+   r = _mm256_sub_ps(r, _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+
+   __m256 p = _mm256_set1_ps(ExpSeriesF[0]);
+   for (int k = 1; k < 9; k++)
+      p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(ExpSeriesF[k]));
+
+   __m256i scale = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+   return _mm256_mul_ps(p, _mm256_castsi256_ps(scale));
+}
+
+// DragRetardationVelocity4, 8 lanes of float, with the bands gathered from FloatBands.
+static inline __m256 DragRetardationVelocityF8(const DragModel* model, __m256 bc, __m256 v)
+{
+   __m256 valid = _mm256_and_ps(_mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_cmp_ps(v, _mm256_set1_ps((float)DRAG_MAXVELOCITY), _CMP_LT_OQ));
+   v = _mm256_blendv_ps(_mm256_set1_ps(1.0f), v, valid);
+
+   __m256i cell = _mm256_cvttps_epi32(v);
+   __m256i band = _mm256_and_si256(_mm256_i32gather_epi32((const int*)model->Grid, cell, 1), _mm256_set1_epi32(0xFF));
+   band = _mm256_mullo_epi32(band, _mm256_set1_epi32(3));
+   __m256 threshold = _mm256_i32gather_ps(&model->FloatBands[0][0], band, 4);
+   __m256 below = _mm256_cmp_ps(v, threshold, _CMP_LE_OQ);
+   band = _mm256_add_epi32(band, _mm256_and_si256(_mm256_castps_si256(below), _mm256_set1_epi32(3)));
+
+   __m256 A = _mm256_i32gather_ps(&model->FloatBands[0][1], band, 4);
+   __m256 M = _mm256_i32gather_ps(&model->FloatBands[0][2], band, 4);
+
+   __m256 val = _mm256_div_ps(_mm256_mul_ps(A, ExpF8(_mm256_mul_ps(M, LogF8(v)))), bc);
+   return _mm256_blendv_ps(_mm256_set1_ps(-1.0f), val, valid);
+}
+
+#endif
+
+#if defined(__AVX512F__)
+
+// The AVX-512 versions of Log4 and Exp4, using getexp/getmant and scalef for the 2^e parts.
+static inline __m512d Log8(__m512d v)
+{
+   __m512d e = _mm512_getexp_pd(v);
+   __m512d m = _mm512_getmant_pd(v, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src);
+
+   __mmask8 big = _mm512_cmp_pd_mask(m, _mm512_set1_pd(1.4142135623730951), _CMP_GT_OQ);
+   m = _mm512_mask_mul_pd(m, big, m, _mm512_set1_pd(0.5));
+   e = _mm512_mask_add_pd(e, big, e, _mm512_set1_pd(1.0));
+
+   __m512d s = _mm512_div_pd(_mm512_sub_pd(m, _mm512_set1_pd(1.0)), _mm512_add_pd(m, _mm512_set1_pd(1.0)));
+   __m512d z = _mm512_mul_pd(s, s);
+   __m512d p = _mm512_set1_pd(LogSeries[0]);
+   for (int k = 1; k < 11; k++)
+      p = _mm512_fmadd_pd(p, z, _mm512_set1_pd(LogSeries[k]));
+
+   return _mm512_fmadd_pd(e, _mm512_set1_pd(0.69314718055994530942), _mm512_mul_pd(_mm512_add_pd(s, s), p));
+}
+
+static inline __m512d Exp8(__m512d x)
+{
+   x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(-700.0)), _mm512_set1_pd(700.0));
+   __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(1.4426950408889634074)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+   __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(6.93145751953125e-1), x);
+   r = _mm512_fnmadd_pd(n, _mm512_set1_pd(1.42860682030941723212e-6), r);
+
+   __m512d p = _mm512_set1_pd(ExpSeries[0]);
+   for (int k = 1; k < 14; k++)
+      p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(ExpSeries[k]));
+
+   return _mm512_scalef_pd(p, n);
+}
+
+static inline __m512d DragRetardationVelocity8(const DragModel* model, __m512d bc, __m512d v)
+{
+   __mmask8 valid = _mm512_cmp_pd_mask(v, _mm512_setzero_pd(), _CMP_GT_OQ) & _mm512_cmp_pd_mask(v, _mm512_set1_pd(DRAG_MAXVELOCITY), _CMP_LT_OQ);
+   v = _mm512_mask_blend_pd(valid, _mm512_set1_pd(1.0), v);
+
+   __m256i cell = _mm512_cvttpd_epi32(v);
+   __m256i band = _mm256_and_si256(_mm256_i32gather_epi32((const int*)model->Grid, cell, 1), _mm256_set1_epi32(0xFF));
+   band = _mm256_mullo_epi32(band, _mm256_set1_epi32(3));
+   __m512d threshold = _mm512_i32gather_pd(band, &model->Bands[0].Velocity, 8);
+   __mmask8 below = _mm512_cmp_pd_mask(v, threshold, _CMP_LE_OQ);
+   band = _mm256_add_epi32(band, _mm512_cvttpd_epi32(_mm512_maskz_mov_pd(below, _mm512_set1_pd(3.0))));
+
+   __m512d A = _mm512_i32gather_pd(band, &model->Bands[0].A, 8);
+   __m512d M = _mm512_i32gather_pd(band, &model->Bands[0].M, 8);
+
+   __m512d val = _mm512_div_pd(_mm512_mul_pd(A, Exp8(_mm512_mul_pd(M, Log8(v)))), bc);
+   return _mm512_mask_blend_pd(valid, _mm512_set1_pd(-1.0), val);
+}
+
+// LogF8, ExpF8 and DragRetardationVelocityF8, 16 lanes wide.
+static inline __m512 LogF16(__m512 v)
+{
+   __m512 e = _mm512_getexp_ps(v);
+   __m512 m = _mm512_getmant_ps(v, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src);
+
+   __mmask16 big = _mm512_cmp_ps_mask(m, _mm512_set1_ps(1.41421356f), _CMP_GT_OQ);
+   m = _mm512_mask_mul_ps(m, big, m, _mm512_set1_ps(0.5f));
+   e = _mm512_mask_add_ps(e, big, e, _mm512_set1_ps(1.0f));
+
+   __m512 s = _mm512_div_ps(_mm512_sub_ps(m, _mm512_set1_ps(1.0f)), _mm512_add_ps(m, _mm512_set1_ps(1.0f)));
+   __m512 z = _mm512_mul_ps(s, s);
+   __m512 p = _mm512_set1_ps(LogSeriesF[0]);
+   for (int k = 1; k < 6; k++)
+      p = _mm512_fmadd_ps(p, z, _mm512_set1_ps(LogSeriesF[k]));
+
+   return _mm512_fmadd_ps(e, _mm512_set1_ps(0.693147181f), _mm512_mul_ps(_mm512_add_ps(s, s), p));
+}
+
+static inline __m512 ExpF16(__m512 x)
+{
+   x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(-87.0f)), _mm512_set1_ps(87.0f));
+   __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(1.44269504f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+   __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), x);
+   r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f), r);
+
+   __m512 p = _mm512_set1_ps(ExpSeriesF[0]);
+   for (int k = 1; k < 9; k++)
+      p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(ExpSeriesF[k]));
+
+   return _mm512_scalef_ps(p, n);
+}
+
+static inline __m512 DragRetardationVelocityF16(const DragModel* model, __m512 bc, __m512 v)
+{
+   __mmask16 valid = _mm512_cmp_ps_mask(v, _mm512_setzero_ps(), _CMP_GT_OQ) & _mm512_cmp_ps_mask(v, _mm512_set1_ps((float)DRAG_MAXVELOCITY), _CMP_LT_OQ);
+   v = _mm512_mask_blend_ps(valid, _mm512_set1_ps(1.0f), v);
+
+   __m512i cell = _mm512_cvttps_epi32(v);
+   __m512i band = _mm512_and_si512(_mm512_i32gather_epi32(cell, (const int*)model->Grid, 1), _mm512_set1_epi32(0xFF));
+   band = _mm512_mullo_epi32(band, _mm512_set1_epi32(3));
+   __mmask16 below = _mm512_cmp_ps_mask(v, _mm512_i32gather_ps(band, &model->FloatBands[0][0], 4), _CMP_LE_OQ);
+   band = _mm512_mask_add_epi32(band, below, band, _mm512_set1_epi32(3));
+
+   __m512 A = _mm512_i32gather_ps(band, &model->FloatBands[0][1], 4);
+   __m512 M = _mm512_i32gather_ps(band, &model->FloatBands[0][2], 4);
+
+   __m512 val = _mm512_div_ps(_mm512_mul_ps(A, ExpF16(_mm512_mul_ps(M, LogF16(v)))), bc);
+   return _mm512_mask_blend_ps(valid, _mm512_set1_ps(-1.0f), val);
+}
+
+#endif
+
+void DragRetardationVelocityN(EDragFunction DragFunction, const double* DragCoefficient, const double* Velocity, double* Retardation, int Count)
+{
+   const DragModel* model = GetDragModel(DragFunction);
+   int i = 0;
+
+   if (!model)
+   {
+      for (; i < Count; i++)
+         Retardation[i] = -1;
+      return;
+   }
+
+#if defined(__AVX512F__)
+   for (; i + 8 <= Count; i += 8)
+   {
+      _mm512_storeu_pd(Retardation + i, DragRetardationVelocity8(model, _mm512_loadu_pd(DragCoefficient + i), _mm512_loadu_pd(Velocity + i)));
+   }
+#endif
+
+#if defined(__AVX2__)
+   for (; i + 4 <= Count; i += 4)
+   {
+      _mm256_storeu_pd(Retardation + i, DragRetardationVelocity4(model, _mm256_loadu_pd(DragCoefficient + i), _mm256_loadu_pd(Velocity + i)));
+   }
+#endif
+
+   // Scalar fallback.
+   for (; i < Count; i++)
+   {
+      double vp = Velocity[i];
+      if (vp > 0 && vp < DRAG_MAXVELOCITY)
+      {
+         const DragBand& band = FindDragBand(model, vp);
+         Retardation[i] = band.A * exp(band.M * log(vp)) / DragCoefficient[i];
+      }
+      else
+      {
+         Retardation[i] = -1;
+      }
+   }
+}
+
+void DragRetardationVelocityN(EDragFunction DragFunction, const float* DragCoefficient, const float* Velocity, float* Retardation, int Count)
+{
+   const DragModel* model = GetDragModel(DragFunction);
+   int i = 0;
+
+   if (!model)
+   {
+      for (; i < Count; i++)
+         Retardation[i] = -1;
+      return;
+   }
+
+#if defined(__AVX512F__)
+   for (; i + 16 <= Count; i += 16)
+   {
+      _mm512_storeu_ps(Retardation + i, DragRetardationVelocityF16(model, _mm512_loadu_ps(DragCoefficient + i), _mm512_loadu_ps(Velocity + i)));
+   }
+#endif
+
+#if defined(__AVX2__)
+   for (; i + 8 <= Count; i += 8)
+   {
+      _mm256_storeu_ps(Retardation + i, DragRetardationVelocityF8(model, _mm256_loadu_ps(DragCoefficient + i), _mm256_loadu_ps(Velocity + i)));
+   }
+#endif
+
+   // Scalar fallback.
+   for (; i < Count; i++)
+   {
+      float vp = Velocity[i];
+      if (vp > 0 && vp < DRAG_MAXVELOCITY)
+      {
+         const float* band = model->FloatBands[&FindDragBand(model, vp) - model->Bands];
+         Retardation[i] = band[1] * expf(band[2] * logf(vp)) / DragCoefficient[i];
+      }
+      else
+      {
+         Retardation[i] = -1;
+      }
+   }
+}
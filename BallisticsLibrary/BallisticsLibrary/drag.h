@@ -0,0 +1,111 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _DRAG_
+#define _DRAG_
+
+#include "ballistics.h"
+
+#define DRAG_MAXMODELS (GCustomLast+1)
+#define DRAG_MAXBANDS 128
+#define DRAG_MAXVELOCITY 10000 // DragRetardationVelocity returns -1 at or above this velocity, in ft/s.
+#define DRAG_SPEEDOFSOUND SPEEDOFSOUND // used to convert Mach numbers
+
+#if defined(_MSC_VER)
+#define DRAG_CACHEALIGN __declspec(align(64))
+#else
+#define DRAG_CACHEALIGN __attribute__((aligned(64)))
+#endif
+
+// One velocity band of a drag model.  Above Velocity (and below the previous band),
+// the drag retardation is A * v^M / DragCoefficient.
+struct DragBand
+{
+   double Velocity;
+   double A;
+   double M;
+};
+
+// A drag model, precompiled for O(1) band lookup.  Bands are sorted by descending Velocity, the
+// last one starts at 0 ft/s, and the rest of the array is zero padding.  Grid[j] is the first band
+// below j+1 ft/s, so the band of a velocity v is Grid[(int)v], or the one after it if v is not
+// above that band's Velocity.  Grid has 3 bytes of padding so it can be read 4 bytes at a time.
+struct DRAG_CACHEALIGN DragModel
+{
+   int BandCount;
+   DragBand Bands[DRAG_MAXBANDS];
+   float FloatBands[DRAG_MAXBANDS][3]; // each band's Velocity, A and M, rounded to float, for the float DragRetardationVelocityN
+   unsigned char Grid[DRAG_MAXVELOCITY+3];
+};
+
+// All drag functions, built-in and registered, live in one registry indexed by EDragFunction.
+// G1, G2, G5, G6, G7 and G8 are compiled into it on first use, so static
+// initializers elsewhere find them too.  G3 and G4 have no built-in
+// coefficients and stay empty (retardation -1) unless SetDragModel fills them.
+// The registry is not locked: register models at startup, before any projectile is stepped.
+
+// Returns the drag model of a drag function, or NULL if it is out of range or empty.
+const DragModel* GetDragModel(EDragFunction DragFunction);
+
+// Returns 1 if a drag function is one of the built-in G functions and the registry still holds its
+// built-in bands (SetDragModel has not replaced them), or 0 otherwise.
+int IsStandardDragModel(EDragFunction DragFunction);
+
+// Installs power-law velocity bands as the drag model of a drag function, replacing any
+// model it had.  Returns 1 on success, or 0 if the bands are not usable.
+int SetDragModel(EDragFunction DragFunction, const DragBand* Bands, int BandCount);
+/* Arguments:
+      DragFunction:  The drag function to define, G1 to GCustomLast.
+      Bands:  The velocity bands, sorted by descending Velocity, at least 1 ft/s apart.
+              The last band must start at 0 ft/s.
+      BandCount:  The number of bands, 1 to DRAG_MAXBANDS.
+*/
+
+// Registers a measured drag curve (for example from Doppler radar) as a new drag model.
+// Returns the drag function to use for it, or 0 if the table is not usable or the registry is full.
+EDragFunction RegisterDragModel(const double* Mach, const double* Cd, int Count);
+/* Arguments:
+      Mach:  Count Mach numbers, in increasing order, at least 1 ft/s apart at DRAG_SPEEDOFSOUND.
+      Cd:  Count positive drag coefficients, one per Mach number.
+      Count:  The number of points in the curve, 2 to DRAG_MAXBANDS+1.
+
+   The curve is converted to bands of the form A * v^M, one per pair of adjacent points, passing
+   through both.  The first and last segments are extended down to 0 ft/s and up to DRAG_MAXVELOCITY.
+   A DragCoefficient of 1 with this model means a ballistic coefficient of 1 lb/in^2 against Cd.
+*/
+
+// The band of a drag model that applies to Velocity (0 < Velocity < DRAG_MAXVELOCITY).
+inline const DragBand& FindDragBand(const DragModel* Model, double Velocity)
+{
+   int i = Model->Grid[(int)Velocity];
+   i += (Velocity <= Model->Bands[i].Velocity);
+   return Model->Bands[i];
+}
+
+// Converts a Cd vs Mach table into the bands RegisterDragModel installs.
+// Returns the number of bands written, or 0 if the table is not usable.
+int DragBandsFromCdMach(const double* Mach, const double* Cd, int Count, DragBand* Bands);
+
+// A vectorized DragRetardationVelocity.  Evaluates 8 (AVX-512) or 4 (AVX2) velocities per
+// iteration when the library is compiled for those instruction sets, and the rest one at a time.
+// The band comes from the model's Grid, gathered per lane, and v^M is computed as exp(M*log(v))
+// in each lane, so the result can differ from DragRetardationVelocity by a few units in the last place.
+void DragRetardationVelocityN(EDragFunction DragFunction, const double* DragCoefficient, const double* Velocity, double* Retardation, int Count);
+/* Arguments:
+      DragFunction:  The drag function shared by all the velocities.
+      DragCoefficient:  Count coefficients of drag, one per velocity.
+      Velocity:  Count projectile velocities, in ft/s.
+      Retardation:  Receives Count drag retardation velocities, in ft/s per second.  May be the same array as Velocity.
+                    Out of range velocities (and empty drag models) give -1, like DragRetardationVelocity.
+      Count:  The number of velocities.
+*/
+
+// DragRetardationVelocityN in float, for SingleProjectileBatch and MixedProjectileBatch.  Evaluates 16
+// (AVX-512) or 8 (AVX2) velocities per iteration, twice the lanes of the double version, and the rest one
+// at a time, all in float: the result is within about 5e-6 of DragRetardationVelocity, relative.
+// The vector versions are bound by their gathers, one per lane for each band field, so under AVX-512
+// the float version is no faster than the double one; under AVX2 it is about twice as fast.
+void DragRetardationVelocityN(EDragFunction DragFunction, const float* DragCoefficient, const float* Velocity, float* Retardation, int Count);
+
+#endif
@@ -0,0 +1,50 @@
+#include "instrument.h"
+
+#include <string.h>
+
+#ifdef BALLISTICS_INSTRUMENT
+
+thread_local BallisticsStats ThreadBallisticsStats;
+BallisticsTraceHandler BallisticsTraceTarget = NULL;
+static void* BallisticsTraceContext = NULL;
+
+void SendBallisticsTrace(EBallisticsTrace Event, const Projectile& projectile, double Value, double Height, long long Steps, double Seconds)
+{
+   BallisticsTrace trace = { Event, &projectile, Value, Height, Steps, Seconds };
+   BallisticsTraceTarget(trace, BallisticsTraceContext);
+}
+
+BallisticsStats GetBallisticsStats()
+{
+   return ThreadBallisticsStats;
+}
+
+void ResetBallisticsStats()
+{
+   memset(&ThreadBallisticsStats, 0, sizeof(ThreadBallisticsStats));
+}
+
+void SetBallisticsTrace(BallisticsTraceHandler Handler, void* Context)
+{
+   BallisticsTraceContext = Context;
+   BallisticsTraceTarget = Handler;
+}
+
+#else
+
+BallisticsStats GetBallisticsStats()
+{
+   BallisticsStats stats;
+   memset(&stats, 0, sizeof(stats));
+   return stats;
+}
+
+void ResetBallisticsStats()
+{
+}
+
+void SetBallisticsTrace(BallisticsTraceHandler, void*)
+{
+}
+
+#endif
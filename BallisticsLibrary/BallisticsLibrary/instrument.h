@@ -0,0 +1,136 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _INSTRUMENT_
+#define _INSTRUMENT_
+
+#include "ballistics.h"
+#include "drag.h"
+
+// Optional instrumentation of the integration engine, to tell why a solve is slow: too many steps,
+// flights that never get steep enough to stop early, or zeros that take many trial shots.
+//
+// It is compiled in only when BALLISTICS_INSTRUMENT is defined (the CMake option of the same name
+// defines it for the library and everything that links it).  Otherwise the BALLISTICS_ macros below
+// expand to nothing, GetBallisticsStats returns zeros, and SetBallisticsTrace does nothing.
+//
+// The counters are per thread, so they cost no locking: a thread sees what it ran itself, and a
+// BatchSolver's work is counted on its pool's threads.
+
+// What the calling thread has run since it started, or since ResetBallisticsStats.
+struct BallisticsStats
+{
+   long long Steps;            // integration steps taken: trapezoidal steps, and accepted RK45 steps
+   long long RejectedSteps;    // RK45 steps retried with a smaller step for exceeding the tolerance
+   long long DragEvaluations;  // drag retardations computed, from drag functions and RetardationTables (but not DragRetardationVelocityN)
+   long long SteepExits;       // flights and trial shots ended early by getting too steep (vy > 3 vx)
+   long long Solves;           // SolveAll calls
+   long long Zeros;            // CalculateSightToBoreAngle calls
+   long long ZeroIterations;   // trial shots fired by CalculateSightToBoreAngle
+   long long BandHits[DRAG_MAXBANDS]; // drag evaluations per band index, of whichever drag functions were used
+   double SolveSeconds;        // wall time spent in SolveAll
+   double ZeroSeconds;         // wall time spent in CalculateSightToBoreAngle
+};
+
+// Returns the calling thread's counters.
+BallisticsStats GetBallisticsStats();
+
+// Sets the calling thread's counters to 0.
+void ResetBallisticsStats();
+
+// What a trace call reports.
+enum EBallisticsTrace
+{
+   TRACE_SOLVE,          // SolveAll returned.  Value: the rows it produced.
+   TRACE_ZERO,           // CalculateSightToBoreAngle returned.  Value: the angle it found, in degrees.
+   TRACE_ZEROITERATION   // a trial shot of CalculateSightToBoreAngle.  Value: its angle, in degrees.  Height: its height at the zero range, in feet.
+};
+
+struct BallisticsTrace
+{
+   EBallisticsTrace Event;
+   const Projectile* projectile;
+   double Value;
+   double Height;
+   long long Steps;  // TRACE_SOLVE and TRACE_ZERO: the steps the call took
+   double Seconds;   // TRACE_SOLVE and TRACE_ZERO: the wall time of the call
+};
+
+// Receives trace calls, on the thread that made them.  Context is the pointer given to SetBallisticsTrace.
+typedef void (*BallisticsTraceHandler)(const BallisticsTrace& Trace, void* Context);
+
+// Sets the handler trace calls go to, from every thread, or NULL for none.  Like the drag registry,
+// it is not locked: set it before any projectile is solved.
+void SetBallisticsTrace(BallisticsTraceHandler Handler, void* Context);
+
+#ifdef BALLISTICS_INSTRUMENT
+
+#include <chrono>
+
+extern thread_local BallisticsStats ThreadBallisticsStats;
+extern BallisticsTraceHandler BallisticsTraceTarget;
+
+void SendBallisticsTrace(EBallisticsTrace Event, const Projectile& projectile, double Value, double Height, long long Steps, double Seconds);
+
+// Times a SolveAll or CalculateSightToBoreAngle call, counting it and tracing its result when it ends.
+class BallisticsCall
+{
+public:
+   BallisticsCall(EBallisticsTrace Event, const Projectile& projectile)
+      : Event(Event), projectile(projectile), Value(0), Steps(ThreadBallisticsStats.Steps), Start(std::chrono::steady_clock::now())
+   {
+   }
+
+   ~BallisticsCall()
+   {
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+      BallisticsStats& stats = ThreadBallisticsStats;
+      if (Event == TRACE_SOLVE)
+      {
+         stats.Solves++;
+         stats.SolveSeconds += seconds;
+      }
+      else
+      {
+         stats.Zeros++;
+         stats.ZeroSeconds += seconds;
+      }
+
+      if (BallisticsTraceTarget)
+         SendBallisticsTrace(Event, projectile, Value, 0, stats.Steps - Steps, seconds);
+   }
+
+   // Notes the value the call returns, for its trace.
+   template <class T> T Result(T Value)
+   {
+      this->Value = Value;
+      return Value;
+   }
+
+private:
+   EBallisticsTrace Event;
+   const Projectile& projectile;
+   double Value;
+   long long Steps;
+   std::chrono::steady_clock::time_point Start;
+};
+
+#define BALLISTICS_COUNT(Field) (ThreadBallisticsStats.Field++)
+#define BALLISTICS_COUNT_BAND(Band) (ThreadBallisticsStats.DragEvaluations++, ThreadBallisticsStats.BandHits[Band]++)
+#define BALLISTICS_CALL(Call, Event, projectile) BallisticsCall Call(Event, projectile)
+#define BALLISTICS_RESULT(Call, Value) (Call).Result(Value)
+#define BALLISTICS_ZEROITERATION(projectile, Angle, Height) \
+   (ThreadBallisticsStats.ZeroIterations++, BallisticsTraceTarget ? SendBallisticsTrace(TRACE_ZEROITERATION, projectile, RadtoDeg(Angle), Height, 0, 0) : (void)0)
+
+#else
+
+#define BALLISTICS_COUNT(Field) ((void)0)
+#define BALLISTICS_COUNT_BAND(Band) ((void)0)
+#define BALLISTICS_CALL(Call, Event, projectile)
+#define BALLISTICS_RESULT(Call, Value) (Value)
+#define BALLISTICS_ZEROITERATION(projectile, Angle, Height) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,237 @@
+#include "integrator.h"
+#include "instrument.h"
+
+// Dormand-Prince 5(4) coefficients.
+static const double A21 = 1.0/5;
+static const double A31 = 3.0/40, A32 = 9.0/40;
+static const double A41 = 44.0/45, A42 = -56.0/15, A43 = 32.0/9;
+static const double A51 = 19372.0/6561, A52 = -25360.0/2187, A53 = 64448.0/6561, A54 = -212.0/729;
+static const double A61 = 9017.0/3168, A62 = -355.0/33, A63 = 46732.0/5247, A64 = 49.0/176, A65 = -5103.0/18656;
+static const double B1 = 35.0/384, B3 = 500.0/1113, B4 = 125.0/192, B5 = -2187.0/6784, B6 = 11.0/84;
+// Differences between the 5th and 4th order weights, for the error estimate.
+static const double E1 = 71.0/57600, E3 = -71.0/16695, E4 = 71.0/1920, E5 = -17253.0/339200, E6 = 22.0/525, E7 = -1.0/40;
+
+DormandPrince::DormandPrince(Projectile& projectile, double Gx, double Gy, double headwind_feet_sec)
+   : projectile(projectile)
+{
+   this->Gx = Gx;
+   this->Gy = Gy;
+   this->headwind_feet_sec = headwind_feet_sec;
+   // A RetardationTable is continuous across the band edges, so with one there are no edges to fit steps to,
+   // and every stage takes its drag from the table.
+   this->Model = projectile.pRetardationTable ? NULL : GetDragModel(projectile.DragFunction);
+   this->Band = NULL;
+   this->Evaluations = 0;
+}
+
+void DormandPrince::Derivative(const double* State, double* D)
+{
+   double vx = State[STATE_VX];
+   double vy = State[STATE_VY];
+   double v = sqrt(vx*vx+vy*vy);
+
+   // Compute acceleration using the drag function retardation, as Projectile::Update does.
+   double dv;
+   if (Band)
+   {
+      BALLISTICS_COUNT_BAND(Band - Model->Bands);
+      dv = Band->A * pow(v + headwind_feet_sec, Band->M) / projectile.DragCoefficient;
+   }
+   else
+      dv = projectile.DragRetardationVelocity(v + headwind_feet_sec);
+   Evaluations++;
+
+   D[STATE_X] = vx;
+   D[STATE_Y] = vy;
+   D[STATE_VX] = -(vx/v) * dv + Gx;
+   D[STATE_VY] = -(vy/v) * dv + Gy;
+}
+
+// The drag band (index into Model->Bands) of a state, or -1 outside the drag function's domain.
+static int BandOf(const DragModel* Model, const double* State, double headwind_feet_sec)
+{
+   double v = sqrt(State[STATE_VX]*State[STATE_VX]+State[STATE_VY]*State[STATE_VY]) + headwind_feet_sec;
+   if (!Model || !(v > 0 && v < DRAG_MAXVELOCITY))
+      return -1;
+   return (int)(&FindDragBand(Model, v) - Model->Bands);
+}
+
+// The speed of a state, relative to the air.
+static double AirSpeed(const double* State, double headwind_feet_sec)
+{
+   return sqrt(State[STATE_VX]*State[STATE_VX]+State[STATE_VY]*State[STATE_VY]) + headwind_feet_sec;
+}
+
+double DormandPrince::Step(double& h, const double* State, double* D, double* NextState, double* NextD)
+{
+   double k2[STATE_SIZE], k3[STATE_SIZE], k4[STATE_SIZE], k5[STATE_SIZE], k6[STATE_SIZE];
+   double s[STATE_SIZE];
+   double edge = -1; // the band edge velocity this step is being fitted to end at
+   double full = h;  // the step size before it was shortened
+   int landings = 0;
+   int startBand = -1; // the band the step starts in, if it starts on an edge
+
+   for (;;)
+   {
+      int i;
+      for (i = 0; i < STATE_SIZE; i++) s[i] = State[i] + h*(A21*D[i]);
+      Derivative(s, k2);
+      for (i = 0; i < STATE_SIZE; i++) s[i] = State[i] + h*(A31*D[i] + A32*k2[i]);
+      Derivative(s, k3);
+      for (i = 0; i < STATE_SIZE; i++) s[i] = State[i] + h*(A41*D[i] + A42*k2[i] + A43*k3[i]);
+      Derivative(s, k4);
+      for (i = 0; i < STATE_SIZE; i++) s[i] = State[i] + h*(A51*D[i] + A52*k2[i] + A53*k3[i] + A54*k4[i]);
+      Derivative(s, k5);
+      for (i = 0; i < STATE_SIZE; i++) s[i] = State[i] + h*(A61*D[i] + A62*k2[i] + A63*k3[i] + A64*k4[i] + A65*k5[i]);
+      Derivative(s, k6);
+      for (i = 0; i < STATE_SIZE; i++) NextState[i] = State[i] + h*(B1*D[i] + B3*k3[i] + B4*k4[i] + B5*k5[i] + B6*k6[i]);
+      Derivative(NextState, NextD);
+
+      int band = (startBand >= 0) ? startBand : BandOf(Model, State, headwind_feet_sec);
+      int nextBand = BandOf(Model, NextState, headwind_feet_sec);
+      if (band >= 0 && nextBand >= 0 && band != nextBand && edge < 0)
+      {
+         int slowing = (nextBand > band);
+         double target = Model->Bands[slowing ? band : band-1].Velocity;
+         double v0 = AirSpeed(State, headwind_feet_sec);
+
+         if (fabs(v0 - target) <= target*1e-9)
+         {
+            // The previous step ended on this edge: start in the band the step is headed into.
+            startBand = slowing ? band+1 : band-1;
+            Band = &Model->Bands[startBand];
+            Derivative(State, D);
+            Band = NULL;
+            continue;
+         }
+
+         // The step crosses into another drag band.  Cut it short at the first band edge, starting
+         // from where the dense output puts the edge, and take every stage of it with that band's drag.
+         double lo = 0, hi = 1;
+         for (int n = 0; n < 50; n++)
+         {
+            double theta = (lo+hi)/2;
+            double p[STATE_SIZE];
+            InterpolateState(State, D, NextState, NextD, h, theta, p);
+            if ((AirSpeed(p, headwind_feet_sec) > target) == slowing)
+               lo = theta;
+            else
+               hi = theta;
+         }
+         h *= lo;
+         edge = target;
+         Band = &Model->Bands[band];
+         continue;
+      }
+
+      if (edge >= 0)
+      {
+         // Fit the step to end on the edge with Newton's method on its length.
+         double v = AirSpeed(NextState, headwind_feet_sec);
+         double dv = (NextState[STATE_VX]*NextD[STATE_VX]+NextState[STATE_VY]*NextD[STATE_VY]) / (v - headwind_feet_sec);
+         if (landings < 8 && dv != 0 && fabs(v - edge) > edge*1e-10)
+         {
+            h += (edge - v)/dv;
+            landings++;
+            continue;
+         }
+      }
+
+      double error = 0;
+      for (i = 0; i < STATE_SIZE; i++)
+      {
+         double e = fabs(h*(E1*D[i] + E3*k3[i] + E4*k4[i] + E5*k5[i] + E6*k6[i] + E7*NextD[i])) / projectile.Tolerance;
+         if (e > error)
+            error = e;
+      }
+
+      if (error <= 1)
+      {
+         if (Band)
+         {
+            // Past the edge, the drag is that of the next band.
+            Band = NULL;
+            Derivative(NextState, NextD);
+         }
+
+         BALLISTICS_COUNT(Steps);
+         double taken = h;
+         double growth = (error > 0) ? 0.9*pow(error, -0.2) : 5.0;
+         h *= (growth < 5.0) ? growth : 5.0;
+         // A step cut short at a band edge says nothing about the step size beyond it.
+         if (taken < full && h < full)
+            h = full;
+         return taken;
+      }
+
+      BALLISTICS_COUNT(RejectedSteps);
+      double shrink = 0.9*pow(error, -0.2);
+      h *= (shrink > 0.2) ? shrink : 0.2;
+      full = h;
+      edge = -1;
+      landings = 0;
+      Band = NULL;
+   }
+}
+
+double InterpolateTheta(const double* State, const double* D, const double* NextState, const double* NextD, double h, double Target)
+{
+   double x0 = State[STATE_X];
+   double x1 = NextState[STATE_X];
+   double theta = (x1 > x0) ? (Target - x0) / (x1 - x0) : 0;
+
+   // Newton's method on the Hermite cubic for x, from the linear guess.
+   for (int n = 0; n < 8; n++)
+   {
+      double t2 = theta*theta;
+      double x = HermiteInterpolate(x0, D[STATE_X], x1, NextD[STATE_X], h, theta);
+      double slope = (6*t2-6*theta)*x0 + (3*t2-4*theta+1)*h*D[STATE_X] + (6*theta-6*t2)*x1 + (3*t2-2*theta)*h*NextD[STATE_X];
+      if (slope <= 0)
+         break;
+
+      double delta = (x - Target) / slope;
+      theta -= delta;
+      if (theta < 0) theta = 0;
+      if (theta > 1) theta = 1;
+      if (fabs(delta) < 1e-14)
+         break;
+   }
+
+   return theta;
+}
+
+double TrialHeightRK45(Projectile& projectile, double Angle, double Range_feet)
+{
+   DormandPrince integrator(projectile, GRAVITY * sin(Angle), GRAVITY * cos(Angle), 0);
+
+   double State[STATE_SIZE] = { 0, -projectile.SightHeightOverBore/12, projectile.MuzzleVelocity * cos(Angle), projectile.MuzzleVelocity * sin(Angle) };
+   double D[STATE_SIZE];
+   double NextState[STATE_SIZE];
+   double NextD[STATE_SIZE];
+   integrator.Derivative(State, D);
+
+   double h = 50 / projectile.MuzzleVelocity;
+   for (;;)
+   {
+      double taken = integrator.Step(h, State, D, NextState, NextD);
+
+      if (NextState[STATE_X] >= Range_feet)
+      {
+         double theta = InterpolateTheta(State, D, NextState, NextD, taken, Range_feet);
+         return HermiteInterpolate(State[STATE_Y], D[STATE_Y], NextState[STATE_Y], NextD[STATE_Y], taken, theta);
+      }
+
+      // Break early to save CPU time if we won't find a solution.
+      if (NextState[STATE_VY] > 3 * NextState[STATE_VX])
+      {
+         BALLISTICS_COUNT(SteepExits);
+         return NextState[STATE_Y];
+      }
+
+      for (int i = 0; i < STATE_SIZE; i++)
+      {
+         State[i] = NextState[i];
+         D[i] = NextD[i];
+      }
+   }
+}
@@ -0,0 +1,72 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _INTEGRATOR_
+#define _INTEGRATOR_
+
+#include "ballistics.h"
+#include "drag.h"
+
+// The state integrated by DormandPrince: x and y in feet, vx and vy in ft/s, on the same axes as Projectile.
+// Its derivative holds vx, vy and the accelerations ax, ay, in ft/s per second.
+#define STATE_X 0
+#define STATE_Y 1
+#define STATE_VX 2
+#define STATE_VY 3
+#define STATE_SIZE 4
+
+// An adaptive Dormand-Prince 5(4) integrator for a projectile's equations of motion: the same
+// drag and gravity terms as Projectile::Update, integrated with error control instead of a fixed
+// 0.5 ft step.  The drag functions are piecewise, with jumps at their band edges, so each step
+// that would cross an edge is shortened to end on it, and the next step starts in the new band.
+// With a RetardationTable, which interpolates across the edges, steps are not fitted to them.
+class DormandPrince
+{
+public:
+   Projectile& projectile;
+   double Gx;
+   double Gy;
+   double headwind_feet_sec;
+   const DragModel* Model; // the drag function's bands, for band edge location (NULL if empty, or with a RetardationTable)
+   const DragBand* Band;   // when set, the band Derivative takes the drag from, whatever the speed
+   int Evaluations;        // drag evaluations so far
+
+   DormandPrince(Projectile& projectile, double Gx, double Gy, double headwind_feet_sec);
+
+   // The derivative of State: vx, vy, ax, ay.
+   void Derivative(const double* State, double* D);
+
+   // Takes one step, of at most h seconds and within projectile.Tolerance, from State with derivative D.
+   // Writes the new state and its derivative, sets h to the proposed size of the next step,
+   // and returns the size of the step taken.  If State is on a band edge (the previous step ended
+   // there), D is replaced with the derivative in the band the step is headed into.
+   double Step(double& h, const double* State, double* D, double* NextState, double* NextD);
+};
+
+// Cubic Hermite dense output between two steps: the value at theta (0 to 1) of a quantity with
+// values p0, p1 and derivatives d0, d1 (per second) at the ends of a step of h seconds.
+inline double HermiteInterpolate(double p0, double d0, double p1, double d1, double h, double theta)
+{
+   double t2 = theta*theta;
+   double t3 = t2*theta;
+   return (2*t3-3*t2+1)*p0 + (t3-2*t2+theta)*h*d0 + (3*t2-2*t3)*p1 + (t3-t2)*h*d1;
+}
+
+// The state at theta (0 to 1) of a step of h seconds from State to NextState.
+inline void InterpolateState(const double* State, const double* D, const double* NextState, const double* NextD, double h, double theta, double* Out)
+{
+   for (int i = 0; i < STATE_SIZE; i++)
+      Out[i] = HermiteInterpolate(State[i], D[i], NextState[i], NextD[i], h, theta);
+}
+
+// The theta (0 to 1) at which x reaches Target during a step of h seconds, for Target between the
+// x values at the two ends of the step.
+double InterpolateTheta(const double* State, const double* D, const double* NextState, const double* NextD, double h, double Target);
+
+// The RK45 trial shot behind Projectile::ZeroTrialHeight: fires the projectile from the muzzle
+// at Angle radians above the line of sight, with no wind, and returns its height in feet when it
+// reaches Range_feet (interpolated to that exact range), or where it stopped, if it got too steep.
+double TrialHeightRK45(Projectile& projectile, double Angle, double Range_feet);
+
+#endif
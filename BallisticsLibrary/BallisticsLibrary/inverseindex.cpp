@@ -0,0 +1,328 @@
+#include "inverseindex.h"
+
+#include <algorithm>
+
+#define INVERSE_ITERATIONS 100 // of the Illinois method, which converges long before
+#define INVERSE_TOLERANCE 1e-12 // relative, in range
+
+// A function of range the index solves for.
+struct InverseIndex::Curve
+{
+   enum EKind
+   {
+      PATH,       // the path less Tilt inches a yard of range
+      TIME,       // the time of flight
+      SLOPE,      // the slope of the path, in inches a yard
+      INTERCEPT   // where the tangent to the path meets the muzzle, in inches: Path - PathSlope * Range
+   } Kind;
+   double Tilt;
+};
+
+// A cubic Hermite spline between (x0, y0) and (x1, y1) with slopes d0 and d1: its value at x, and its slope.
+static double Hermite(double x0, double x1, double y0, double y1, double d0, double d1, double x, double& Slope)
+{
+   double h = x1 - x0;
+   double s = (x - x0) / h;
+   double s2 = s*s;
+   double s3 = s2*s;
+   Slope = ((6*s2 - 6*s) * (y0 - y1)) / h + (3*s2 - 4*s + 1) * d0 + (3*s2 - 2*s) * d1;
+   return (2*s3 - 3*s2 + 1) * y0 + (s3 - 2*s2 + s) * h * d0 + (-2*s3 + 3*s2) * y1 + (s3 - s2) * h * d1;
+}
+
+InverseIndex::InverseIndex()
+   : ApexRange(0), MOATurn(0)
+{
+}
+
+int InverseIndex::Build(const double* Table, int RowCount, int Columns)
+{
+   Range.clear();
+   Path.clear();
+   PathSlope.clear();
+   Time.clear();
+   TimeSlope.clear();
+   if ((Columns & INVERSE_COLUMNS) != INVERSE_COLUMNS || RowCount < 2)
+      return 0;
+
+   // Where each column falls in a packed row.
+   int columns = PathColumnCount(Columns);
+   int range = PathColumnCount(Columns & (PATH_RANGE-1));
+   int path = PathColumnCount(Columns & (PATH_PATH-1));
+   int time = PathColumnCount(Columns & (PATH_TIME-1));
+   int vx = PathColumnCount(Columns & (PATH_VX-1));
+   int vy = PathColumnCount(Columns & (PATH_VY-1));
+
+   Range.resize(RowCount);
+   Path.resize(RowCount);
+   PathSlope.resize(RowCount);
+   Time.resize(RowCount);
+   TimeSlope.resize(RowCount);
+   for (int r = 0; r < RowCount; r++)
+   {
+      const double* row = &Table[(size_t)r*columns];
+      Range[r] = row[range];
+      Path[r] = row[path];
+      PathSlope[r] = 36*row[vy]/row[vx];
+      Time[r] = row[time];
+      TimeSlope[r] = 3/row[vx];
+   }
+
+   // The turning points.  The slope only falls, and the intercept only rises, as long as gravity
+   // pulls the path down, so each crosses 0 once at most.
+   double first = Range.front(), last = Range.back();
+   Curve slope = { Curve::SLOPE, 0 };
+   if (PathSlope.front() <= 0)
+      ApexRange = first;
+   else if (PathSlope.back() >= 0)
+      ApexRange = last;
+   else
+      FindCrossings(slope, 0, NULL, 0, &ApexRange, 1);
+
+   Curve intercept = { Curve::INTERCEPT, 0 };
+   if (RowValue(intercept, 0) >= 0)
+      MOATurn = first;
+   else if (RowValue(intercept, RowCount-1) <= 0)
+      MOATurn = last;
+   else
+      FindCrossings(intercept, 0, NULL, 0, &MOATurn, 1);
+
+   return 1;
+}
+
+int InverseIndex::Build(const SolutionRequest& Request, const SolutionResult& Result)
+{
+   return Build(Result.Table.data(), Result.RowCount, Request.Columns);
+}
+
+// The row at or before a range, and before the last, so that the range is between it and the next.
+int InverseIndex::FindRow(double Range_yard) const
+{
+   int row = (int)(std::upper_bound(Range.begin(), Range.end(), Range_yard) - Range.begin()) - 1;
+   return std::max(0, std::min(row, (int)Range.size() - 2));
+}
+
+double InverseIndex::RowValue(const Curve& curve, int Row) const
+{
+   switch (curve.Kind)
+   {
+   case Curve::PATH: return Path[Row] - curve.Tilt*Range[Row];
+   case Curve::TIME: return Time[Row];
+   case Curve::SLOPE: return PathSlope[Row];
+   case Curve::INTERCEPT:
+   default: return Path[Row] - PathSlope[Row]*Range[Row];
+   }
+}
+
+// A curve's value at a range between Row and the next.
+double InverseIndex::Evaluate(const Curve& curve, int Row, double Range_yard) const
+{
+   double x0 = Range[Row], x1 = Range[Row+1];
+   double slope;
+   if (curve.Kind == Curve::TIME)
+      return Hermite(x0, x1, Time[Row], Time[Row+1], TimeSlope[Row], TimeSlope[Row+1], Range_yard, slope);
+
+   double path = Hermite(x0, x1, Path[Row], Path[Row+1], PathSlope[Row], PathSlope[Row+1], Range_yard, slope);
+   switch (curve.Kind)
+   {
+   case Curve::PATH: return path - curve.Tilt*Range_yard;
+   case Curve::SLOPE: return slope;
+   case Curve::INTERCEPT:
+   default: return path - slope*Range_yard;
+   }
+}
+
+// Solves a curve for a value between two ranges within the interval after Row, where it is LowValue - Value
+// and HighValue - Value, of opposite signs, by the Illinois variant of the method of false position.
+double InverseIndex::SolveBetween(const Curve& curve, double Value, int Row, double Low, double High, double LowValue, double HighValue) const
+{
+   double a = Low, b = High;
+   double fa = LowValue - Value, fb = HighValue - Value;
+   double c = a;
+   int side = 0;
+   for (int n = 0; n < INVERSE_ITERATIONS; n++)
+   {
+      c = (fa*b - fb*a) / (fa - fb);
+      double fc = Evaluate(curve, Row, c) - Value;
+      if (fc == 0)
+         break;
+      if ((fc < 0) == (fb < 0))
+      {
+         b = c;
+         fb = fc;
+         if (side == -1)
+            fa /= 2;
+         side = -1;
+      }
+      else
+      {
+         a = c;
+         fa = fc;
+         if (side == 1)
+            fb /= 2;
+         side = 1;
+      }
+      if (b - a <= INVERSE_TOLERANCE * std::max(1.0, fabs(c)))
+         break;
+   }
+   return c;
+}
+
+// Finds where a curve takes a value, in each of the runs between the turning points, which must be in
+// order, and over each of which the curve crosses the value once at most.
+int InverseIndex::FindCrossings(const Curve& curve, double Value, const double* Turns, int TurnCount, double* Ranges, int MaxCount) const
+{
+   int last = (int)Range.size() - 1;
+   int count = 0;
+   double start = Range[0];
+   double startValue = RowValue(curve, 0);
+   for (int t = 0; t <= TurnCount; t++)
+   {
+      double end = Range[last];
+      double endValue = RowValue(curve, last);
+      if (t < TurnCount)
+      {
+         if (Turns[t] <= start || Turns[t] >= end)
+            continue;
+         end = Turns[t];
+         endValue = Evaluate(curve, FindRow(end), end);
+      }
+
+      // A value at a turning point belongs to the run before it.
+      double low = start, lowValue = startValue - Value;
+      double high = end, highValue = endValue - Value;
+      start = end;
+      startValue = endValue;
+      double found;
+      if (lowValue == 0 && t == 0)
+         found = low;
+      else if (highValue == 0)
+         found = high;
+      else if ((lowValue < 0) != (highValue < 0) && lowValue != 0)
+      {
+         // Binary search the rows of the run for the pair around the value.
+         bool below = lowValue < 0;
+         int i0 = (int)(std::upper_bound(Range.begin(), Range.end(), low) - Range.begin());
+         int i1 = (int)(std::lower_bound(Range.begin(), Range.end(), high) - Range.begin()) - 1;
+         while (i0 <= i1)
+         {
+            int m = (i0 + i1) / 2;
+            double value = RowValue(curve, m) - Value;
+            if (value == 0)
+            {
+               low = high = Range[m];
+               break;
+            }
+            if ((value < 0) == below)
+            {
+               low = Range[m];
+               lowValue = value;
+               i0 = m + 1;
+            }
+            else
+            {
+               high = Range[m];
+               highValue = value;
+               i1 = m - 1;
+            }
+         }
+         int row = std::max(0, std::min(i0 - 1, last - 1));
+         found = (low == high) ? low : SolveBetween(curve, Value, row, low, high, lowValue + Value, highValue + Value);
+      }
+      else
+         continue;
+
+      if (count < MaxCount)
+         Ranges[count] = found;
+      count++;
+   }
+   return count;
+}
+
+int InverseIndex::Interpolate(double Range_yard, ProjectilePath& Out) const
+{
+   Out = ProjectilePath();
+   if (Range.empty() || !(Range_yard >= Range.front() && Range_yard <= Range.back()))
+      return 0;
+
+   int row = FindRow(Range_yard);
+   Curve path = { Curve::PATH, 0 };
+   Curve time = { Curve::TIME, 0 };
+   Out.Range = Range_yard;
+   Out.Path = Evaluate(path, row, Range_yard);
+   Out.MOA = -RadtoMOA(atan(Out.Path/(36*Range_yard)));
+   Out.Time = Evaluate(time, row, Range_yard);
+   return 1;
+}
+
+int InverseIndex::RangesAt(EPathColumn Column, double Value, double* Ranges, int MaxCount) const
+{
+   if (Range.empty())
+      return 0;
+
+   switch (Column)
+   {
+   case PATH_PATH:
+      {
+         Curve path = { Curve::PATH, 0 };
+         return FindCrossings(path, Value, &ApexRange, 1, Ranges, MaxCount);
+      }
+   case PATH_MOA:
+      {
+         // The correction is -atan(Path / (36 Range)), so it takes the value where the path crosses the
+         // line through the muzzle at that angle.
+         Curve line = { Curve::PATH, -36*tan(MOAtoRad(Value)) };
+         return FindCrossings(line, 0, &MOATurn, 1, Ranges, MaxCount);
+      }
+   case PATH_TIME:
+      {
+         Curve time = { Curve::TIME, 0 };
+         return FindCrossings(time, Value, NULL, 0, Ranges, MaxCount);
+      }
+   default:
+      return 0;
+   }
+}
+
+int InverseIndex::PointBlankRange(double Height_inch, PointBlank& Out) const
+{
+   Out = PointBlank();
+   double half = Height_inch / 2;
+   if (Range.empty() || Path.front() < -half)
+      return 0;
+
+   // The best zero raises the path until its apex touches the top of the zone.  The new line of sight
+   // is then parallel to the tangent at the apex, which meets the muzzle half the zone above the old one.
+   Curve intercept = { Curve::INTERCEPT, 0 };
+   double apex;
+   if (FindCrossings(intercept, half, NULL, 0, &apex, 1) == 0)
+      return 0;
+   int row = FindRow(apex);
+   double tilt;
+   Hermite(Range[row], Range[row+1], Path[row], Path[row+1], PathSlope[row], PathSlope[row+1], apex, tilt);
+
+   // The re-zeroed path rises to the apex and falls after it.
+   Curve path = { Curve::PATH, tilt };
+   double bottom[2];
+   int count = FindCrossings(path, -half, &apex, 1, bottom, 2);
+   if (count == 0 || bottom[std::min(count, 2) - 1] <= apex)
+      return 0;
+
+   double zeros[2];
+   int zeroCount = FindCrossings(path, 0, &apex, 1, zeros, 2);
+
+   Out.Range_yard = bottom[std::min(count, 2) - 1];
+   Out.Apex_yard = apex;
+   Out.NearZero_yard = (zeroCount >= 2) ? zeros[0] : Range.front();
+   Out.FarZero_yard = zeros[std::min(zeroCount, 2) - 1];
+   Out.ZeroChange_moa = -RadtoMOA(atan(tilt/36));
+   return 1;
+}
+
+int BuildInverseIndexes(const std::vector<SolutionRequest>& Requests, const std::vector<SolutionResult>& Results, std::vector<InverseIndex>& Indexes)
+{
+   Indexes.resize(Results.size());
+   int built = 0;
+   for (size_t i = 0; i < Results.size(); i++)
+      built += Indexes[i].Build(Requests[i], Results[i]);
+   return built;
+}
@@ -0,0 +1,103 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _INVERSEINDEX_
+#define _INVERSEINDEX_
+
+#include <vector>
+
+#include "ballistics.h"
+#include "batchsolver.h"
+
+// The columns an InverseIndex is built from.  A table may have others; they are ignored.
+#define INVERSE_COLUMNS (PATH_RANGE | PATH_PATH | PATH_TIME | PATH_VX | PATH_VY)
+
+// The maximum point blank range of a load, for a zone Height_inch tall centered on the point of aim:
+// the zero that keeps the path within the zone for the longest, and how far that is.
+struct PointBlank
+{
+   double Range_yard;       // the maximum point blank range: where the path leaves the bottom of the zone
+   double Apex_yard;        // where the path peaks, at the top of the zone
+   double NearZero_yard;    // where the path crosses the line of sight, rising
+   double FarZero_yard;     // where it crosses again, falling: the range to zero the rifle at
+   double ZeroChange_moa;   // the change from the solved zero, in MOA: positive raises the path
+};
+
+// An index of a solved trajectory, answering the inverse questions: the ranges at which the path, the
+// MOA correction or the time of flight take a given value, and the maximum point blank range.
+//
+// The path and time are interpolated between rows as cubic Hermite splines, from their values and
+// slopes (dPath/dRange = 36 Vy/Vx inches a yard, dTime/dRange = 3/Vx seconds a yard), so a table with
+// rows 25 yards apart answers about as closely as one with a row every yard.
+//
+// The path is not monotonic: it rises to its apex and falls, and the MOA correction falls to a least
+// value and rises, a little short of the apex.  The index finds both turning points when it is built,
+// splitting each column into runs over which it only rises or only falls.  A query binary searches
+// each run for the pair of rows around its value, and solves the spline between them, so it takes
+// O(log n) time, and finds the crossing on either side of a turning point.
+//
+// Changing the zero tilts the line of sight.  PointBlankRange treats the tilt as a shear, to first
+// order in its angle: the re-zeroed path at x yards is the solved path less (slope * x).  For changes
+// of a few MOA the error is a small fraction of an inch and a yard.
+//
+// An index is read only once built, so it can be queried from any number of threads.
+class InverseIndex
+{
+public:
+   InverseIndex();
+
+   // Builds the index from a solution table, packed as by SolveTable.  Returns 1 on success, or 0 if
+   // Columns lacks any of INVERSE_COLUMNS, or there are fewer than 2 rows.
+   int Build(const double* Table, int RowCount, int Columns);
+
+   // Builds the index from a BatchSolver solution.  Returns as Build does.
+   int Build(const SolutionRequest& Request, const SolutionResult& Result);
+
+   int RowCount() const { return (int)Range.size(); }
+
+   // Fills in the Range, Path, MOA and Time at a range, and zeroes the rest.  Returns 1, or 0 if the
+   // range is outside the table.
+   int Interpolate(double Range_yard, ProjectilePath& Out) const;
+
+   // Finds the ranges at which a column takes a value, nearest first.
+   /* Arguments:
+         Column:  PATH_PATH (inches), PATH_MOA (the correction, in MOA, as ProjectilePath::MOA), or
+                  PATH_TIME (seconds).
+         Value:  The value.
+         Ranges:  Receives up to MaxCount ranges, in yards.
+
+      Return Value:
+         The number of ranges at which the column takes the value: 0, 1 or 2 (Path and MOA, on either
+         side of their turning point), or 0 for any other column.  Only the first MaxCount are written.
+   */
+   int RangesAt(EPathColumn Column, double Value, double* Ranges, int MaxCount) const;
+
+   // Finds the maximum point blank range for a zone Height_inch tall.  Returns 1, or 0 if the sight is
+   // more than Height_inch/2 above the bore, or the table ends before the path leaves the zone.
+   int PointBlankRange(double Height_inch, PointBlank& Out) const;
+
+private:
+   std::vector<double> Range;      // yards
+   std::vector<double> Path;       // inches
+   std::vector<double> PathSlope;  // inches a yard
+   std::vector<double> Time;       // seconds
+   std::vector<double> TimeSlope;  // seconds a yard
+
+   double ApexRange;   // where the path turns, or the first or last range if it never does
+   double MOATurn;     // where the MOA correction turns, where the tangent to the path passes through the sight
+
+   struct Curve;
+   int FindRow(double Range_yard) const;
+   double RowValue(const Curve& curve, int Row) const;
+   double Evaluate(const Curve& curve, int Row, double Range_yard) const;
+   double SolveBetween(const Curve& curve, double Value, int Row, double Low, double High, double LowValue, double HighValue) const;
+   int FindCrossings(const Curve& curve, double Value, const double* Turns, int TurnCount, double* Ranges, int MaxCount) const;
+};
+
+// Builds an index for each of a batch of solutions, as solved by BatchSolver::Solve, at the same index
+// in Indexes, resizing it to match.  Each request's Columns must include INVERSE_COLUMNS.
+// Returns the number of indexes built: those whose Build returned 1.
+int BuildInverseIndexes(const std::vector<SolutionRequest>& Requests, const std::vector<SolutionResult>& Results, std::vector<InverseIndex>& Indexes);
+
+#endif
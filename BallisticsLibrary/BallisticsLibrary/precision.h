@@ -0,0 +1,42 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _PRECISION_
+#define _PRECISION_
+
+// The floating point precisions the structure-of-arrays engine (see ProjectileBatch) can integrate in.
+// They are offered only there: Projectile, SolveAll, SolveTable and everything built on them always
+// integrate in double, and nothing in the existing API changes precision behind the caller's back.
+// Each one names two types:
+//    Real:         the velocities, the height, the step, gravity and the drag coefficient, and the
+//                  drag evaluation, which is where the time goes
+//    Accumulator:  the range and the time of flight, which grow by a small step thousands of times,
+//                  so in float they pick up a rounding error on every step that never averages out
+//
+// Float halves the memory each round takes and doubles the lanes of a vector drag evaluation.  What
+// it costs in drop and windage is measured by the "Precision" checks of Tests/checks.cpp, out to 2000 yards,
+// against the same rounds flown one by one with Projectile::Update.
+
+// Everything in double: within a few units in the last place of Projectile::Update.
+struct DoublePrecision
+{
+   typedef double Real;
+   typedef double Accumulator;
+};
+
+// Everything in float.
+struct SinglePrecision
+{
+   typedef float Real;
+   typedef float Accumulator;
+};
+
+// Float state, with the range and time accumulated in double.
+struct MixedPrecision
+{
+   typedef float Real;
+   typedef double Accumulator;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "projectilebatch.h"
+#include "drag.h"
+
+template <class Precision>
+BasicProjectileBatch<Precision>::BasicProjectileBatch(EDragFunction DragFunction, int Capacity)
+{
+   this->DragFunction = DragFunction;
+   this->Capacity = Capacity;
+   this->Count = 0;
+   this->NextId = 0;
+
+   vx = new Real[Capacity];
+   vy = new Real[Capacity];
+   x = new Accumulator[Capacity];
+   y = new Real[Capacity];
+   t = new Accumulator[Capacity];
+   dt = new Real[Capacity];
+   Gx = new Real[Capacity];
+   Gy = new Real[Capacity];
+   DragCoefficient = new Real[Capacity];
+   ProjectilePathCount = new int[Capacity];
+   Id = new int[Capacity];
+   Speed = new Real[Capacity];
+   Retardation = new Real[Capacity];
+}
+
+template <class Precision>
+BasicProjectileBatch<Precision>::~BasicProjectileBatch()
+{
+   delete[] vx;
+   delete[] vy;
+   delete[] x;
+   delete[] y;
+   delete[] t;
+   delete[] dt;
+   delete[] Gx;
+   delete[] Gy;
+   delete[] DragCoefficient;
+   delete[] ProjectilePathCount;
+   delete[] Id;
+   delete[] Speed;
+   delete[] Retardation;
+}
+
+template <class Precision>
+int BasicProjectileBatch<Precision>::Add(double DragCoefficient, double MuzzleVelocity, double SightHeightOverBore, double BoreAngle, double SightToBoreAngle)
+{
+   if (Count >= Capacity)
+      return -1;
+
+   int i = Count++;
+
+   // Same initial state as Projectile::Fire, rounded to the batch's precision.
+   this->Gy[i] = (Real)(GRAVITY * cos(DegtoRad((BoreAngle + SightToBoreAngle))));
+   this->Gx[i] = (Real)(GRAVITY * sin(DegtoRad((BoreAngle + SightToBoreAngle))));
+
+   this->vx[i] = (Real)(MuzzleVelocity * cos(DegtoRad(SightToBoreAngle)));
+   this->vy[i] = (Real)(MuzzleVelocity * sin(DegtoRad(SightToBoreAngle)));
+
+   this->x[i] = 0;
+   this->y[i] = (Real)(-SightHeightOverBore/12);
+
+   this->ProjectilePathCount[i] = 0;
+   this->t[i] = 0;
+   this->dt[i] = 0; // SolveAll starts with dt = 0
+   this->DragCoefficient[i] = (Real)DragCoefficient;
+   this->Id[i] = NextId++;
+
+   return this->Id[i];
+}
+
+template <class Precision>
+int BasicProjectileBatch<Precision>::Update(double headwind_mile_hr)
+{
+   Real headwind_feet_sec = (Real)(headwind_mile_hr*5280.0/3600.0);
+   int live = 0;
+
+   // Compute acceleration using the drag function retardation, for all rounds at once.
+   for (int i = 0; i < Count; i++)
+   {
+      Speed[i] = sqrt(vx[i]*vx[i]+vy[i]*vy[i]);
+      Retardation[i] = Speed[i] + headwind_feet_sec;
+   }
+   DragRetardationVelocityN(DragFunction, DragCoefficient, Retardation, Retardation, Count);
+
+   for (int i = 0; i < Count; i++)
+   {
+      // The body of Projectile::Update, without the ProjectilePath bookkeeping,
+      // followed by the "t += dt" SolveAll does after every successful Update.
+      Real vx_last = vx[i];
+      Real vy_last = vy[i];
+      Real step = dt[i];
+
+      Real v = Speed[i];
+      Real dv = Retardation[i];
+      Real dvx = -(vx_last/v) * dv;
+      Real dvy = -(vy_last/v) * dv;
+
+      Real vx_next = vx_last + (step * dvx + step * Gx[i]);
+      Real vy_next = vy_last + (step * dvy + step * Gy[i]);
+
+      int count = ProjectilePathCount[i];
+      if (x[i]/3 >= count)
+         count++;
+
+      Accumulator x_next = x[i] + step * (vx_next+vx_last)/2;
+      Real y_next = y[i] + step * (vy_next+vy_last)/2;
+
+      step = (Real)0.5 / v;
+
+      // A round that terminates keeps the state Projectile::Update leaves, without the "t += dt".
+      if (fabs(vy_next) > fabs(3*vx_next) || count >= BCOMP_MAXRANGE)
+      {
+         FinishedRound round = { Id[i], (double)x_next, (double)y_next, (double)vx_next, (double)vy_next, (double)t[i] };
+         Finished.push_back(round);
+         continue;
+      }
+
+      // Compact the surviving round into the next live slot.
+      vx[live] = vx_next;
+      vy[live] = vy_next;
+      x[live] = x_next;
+      y[live] = y_next;
+      t[live] = t[i] + step;
+      dt[live] = step;
+      Gx[live] = Gx[i];
+      Gy[live] = Gy[i];
+      DragCoefficient[live] = DragCoefficient[i];
+      ProjectilePathCount[live] = count;
+      Id[live] = Id[i];
+      live++;
+   }
+
+   Count = live;
+   return Count;
+}
+
+template class BasicProjectileBatch<DoublePrecision>;
+template class BasicProjectileBatch<SinglePrecision>;
+template class BasicProjectileBatch<MixedPrecision>;
@@ -0,0 +1,101 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _PROJECTILEBATCH_
+#define _PROJECTILEBATCH_
+
+#include <vector>
+
+#include "ballistics.h"
+#include "precision.h"
+
+// A structure-of-arrays engine for stepping many projectiles that share one drag function.
+// Every live round is advanced exactly like Projectile::Update (trapezoidal step, dt = 0.5 / v),
+// but no ProjectilePath rows are recorded, and rounds that terminate are compacted out so the
+// arrays below always hold Count live rounds in slots [0, Count).
+//
+// Use one batch per drag function.  Compaction keeps the relative order of the live rounds;
+// Id[i] tells which round (as returned by Add) currently lives in slot i.  A round's state when it
+// terminates, where it landed and when, is kept in Finished before it is compacted out.
+//
+// The batch integrates in the precision of its Precision policy (see precision.h).  ProjectileBatch,
+// in double, agrees with Projectile::Update to within a few units in the last place (its drag comes from
+// DragRetardationVelocityN, see drag.h); SingleProjectileBatch and MixedProjectileBatch
+// trade some accuracy for half the memory traffic and twice the vector width of the drag evaluation.
+
+// The state of a batch round when it terminated: the members of a Projectile flown alongside it, when its
+// Update returned 0.
+struct FinishedRound
+{
+   int Id;
+   double x;
+   double y;
+   double vx;
+   double vy;
+   double t;
+};
+
+template <class Precision>
+class BasicProjectileBatch
+{
+public:
+   typedef typename Precision::Real Real;
+   typedef typename Precision::Accumulator Accumulator;
+
+   EDragFunction DragFunction;
+
+   int Count;     // number of live rounds
+   int Capacity;  // maximum number of rounds
+
+   Real* vx;
+   Real* vy;
+
+   Accumulator* x;
+   Real* y;
+
+   Accumulator* t;
+   Real* dt; // the step each round will take on the next Update, as returned by Projectile::Update
+   Real* Gx;
+   Real* Gy;
+   Real* DragCoefficient;
+   int* ProjectilePathCount; // the range cursor Projectile::Update keeps, used for the range-limit exit
+   int* Id;
+
+   // The rounds that terminated, in the order they did.  Update only adds to it; clear it as you read it.
+   std::vector<FinishedRound> Finished;
+
+   BasicProjectileBatch(EDragFunction DragFunction, int Capacity);
+   ~BasicProjectileBatch();
+
+   // Fires a new round, like Projectile::Fire.  Returns its Id, or -1 if the batch is full.
+   int Add(double DragCoefficient, double MuzzleVelocity, double SightHeightOverBore, double BoreAngle, double SightToBoreAngle);
+   /* Arguments:
+         DragCoefficient:  The coefficient of drag for the projectile, for the batch's drag function.
+         MuzzleVelocity:  The initial velocity of the projectile, in feet/s.
+         SightHeightOverBore:  The height of the sighting system above the bore centerline, in inches.
+         BoreAngle:  The uphill or downhill shooting angle, in degrees.
+         SightToBoreAngle:  The angle of the sighting system relative to the bore, in degrees.
+   */
+
+   // Advances every live round by one step, and moves the rounds that terminated from the arrays to Finished.
+   // Returns the number of live rounds left.
+   int Update(double headwind_mile_hr);
+
+private:
+   int NextId;
+
+   // Per round scratch for the vectorized drag evaluation.
+   Real* Speed;
+   Real* Retardation;
+
+   // Copying would share (and double free) the arrays.
+   BasicProjectileBatch(const BasicProjectileBatch&);
+   BasicProjectileBatch& operator=(const BasicProjectileBatch&);
+};
+
+typedef BasicProjectileBatch<DoublePrecision> ProjectileBatch;
+typedef BasicProjectileBatch<SinglePrecision> SingleProjectileBatch;
+typedef BasicProjectileBatch<MixedPrecision> MixedProjectileBatch;
+
+#endif
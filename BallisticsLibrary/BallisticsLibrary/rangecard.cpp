@@ -0,0 +1,79 @@
+#include "rangecard.h"
+
+#define RANGECARD_COLUMNS (PATH_RANGE | PATH_PATH | PATH_MOA | PATH_TIME | PATH_VELOCITY)
+
+int SolveRangeCard(const Projectile& projectile, double RangeStep_yard, double MaxRange_yard, const RangeCardWind* Winds, int WindCount, RangeCard& Card)
+{
+   // Group the winds by headwind.
+   std::vector<double> headwinds;
+   Card.WindCount = WindCount;
+   Card.WindFlight.resize(WindCount);
+   for (int w = 0; w < WindCount; w++)
+   {
+      double headwind = HeadWindVelocity(Winds[w].Speed_mile_hr, Winds[w].Angle);
+      size_t f = 0;
+      while (f < headwinds.size() && fabs(headwinds[f] - headwind) > RANGECARD_HEADWIND_TOLERANCE)
+         f++;
+      if (f == headwinds.size())
+         headwinds.push_back(headwind);
+      Card.WindFlight[w] = (int)f;
+   }
+   Card.FlightCount = (int)headwinds.size();
+
+   // Fly each headwind with no crosswind, into a packed table (see SolveTable).
+   int rows = PathTableRows(MaxRange_yard, RangeStep_yard);
+   int columns = PathColumnCount(RANGECARD_COLUMNS);
+   std::vector<double> table((size_t)Card.FlightCount * rows * columns);
+   Card.RowCount = Card.FlightCount ? rows : 0;
+   // One copy to fly, put back where the projectile was fired from before each flight; copying the
+   // projectile again would copy any rows it recorded, for nothing.
+   Projectile flight = projectile;
+   FlightCheckpoint fired;
+   projectile.SaveCheckpoint(fired, 0);
+   for (int f = 0; f < Card.FlightCount; f++)
+   {
+      double dt;
+      flight.Resume(fired, dt);
+      int reached = SolveTable(headwinds[f], 0, flight, RangeStep_yard, MaxRange_yard, RANGECARD_COLUMNS, &table[(size_t)f*rows*columns]);
+      if (reached < Card.RowCount)
+         Card.RowCount = reached;
+   }
+
+   int n = Card.RowCount;
+   Card.Range.resize((size_t)Card.FlightCount * n);
+   Card.Path.resize((size_t)Card.FlightCount * n);
+   Card.MOA.resize((size_t)Card.FlightCount * n);
+   Card.Time.resize((size_t)Card.FlightCount * n);
+   Card.Velocity.resize((size_t)Card.FlightCount * n);
+   for (int f = 0; f < Card.FlightCount; f++)
+   {
+      for (int r = 0; r < n; r++)
+      {
+         const double* row = &table[((size_t)f*rows + r) * columns];
+         Card.Range[(size_t)f*n + r] = row[0];
+         Card.Path[(size_t)f*n + r] = row[1];
+         Card.MOA[(size_t)f*n + r] = row[2];
+         Card.Time[(size_t)f*n + r] = row[3];
+         Card.Velocity[(size_t)f*n + r] = row[4];
+      }
+   }
+
+   // The windage of each wind, from its flight's times, as Projectile::PathRow computes it.
+   Card.Windage.resize((size_t)WindCount * n);
+   Card.WindageMOA.resize((size_t)WindCount * n);
+   for (int w = 0; w < WindCount; w++)
+   {
+      double crosswind = CrossWindVelocity(Winds[w].Speed_mile_hr, Winds[w].Angle);
+      const double* range = &Card.Range[(size_t)Card.WindFlight[w]*n];
+      const double* time = &Card.Time[(size_t)Card.WindFlight[w]*n];
+      for (int r = 0; r < n; r++)
+      {
+         double x = range[r]*3;
+         double correction = flight.WindageCorrection(crosswind, projectile.MuzzleVelocity, x, time[r]);
+         Card.Windage[(size_t)w*n + r] = correction;
+         Card.WindageMOA[(size_t)w*n + r] = RadtoMOA(atan(correction/(12*x)));
+      }
+   }
+
+   return n;
+}
@@ -0,0 +1,66 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _RANGECARD_
+#define _RANGECARD_
+
+#include <vector>
+
+#include "ballistics.h"
+
+#define RANGECARD_HEADWIND_TOLERANCE 1e-9 // winds whose headwinds differ by no more than this, in mi/hr, share a flight
+
+// One wind of a range card.
+struct RangeCardWind
+{
+   double Speed_mile_hr;
+   double Angle;         // in degrees, as for SolveAll
+};
+
+// A range card: a row every RangeStep_yard yards, with the windage for each of several winds.
+//
+// A wind's crosswind only enters the solution through WindageCorrection, after the flight, so winds with
+// the same headwind share one flight, and their windage columns are computed from its times of flight.
+// The columns that do depend on the flight are kept once per flight; WindFlight says which one a wind uses.
+// Winds straight across (90 and 270 degrees) all have no headwind, so a card of those takes one flight.
+struct RangeCard
+{
+   int RowCount;
+   int WindCount;
+   int FlightCount;
+
+   std::vector<int> WindFlight;     // WindCount
+
+   // FlightCount x RowCount, as the ProjectilePath fields of the same names.
+   std::vector<double> Range;
+   std::vector<double> Path;
+   std::vector<double> MOA;
+   std::vector<double> Time;
+   std::vector<double> Velocity;
+
+   // WindCount x RowCount, as the ProjectilePath fields of the same names.
+   std::vector<double> Windage;
+   std::vector<double> WindageMOA;
+
+   // The row of a wind, with all but Vx and Vy filled in.
+   ProjectilePath Row(int Wind, int Row) const
+   {
+      size_t flight = (size_t)WindFlight[Wind]*RowCount + Row;
+      size_t wind = (size_t)Wind*RowCount + Row;
+      ProjectilePath row = { Range[flight], Path[flight], MOA[flight], Time[flight], Windage[wind], WindageMOA[wind], Velocity[flight], 0, 0 };
+      return row;
+   }
+};
+
+// A function to solve a range card for several winds, flying once per distinct headwind.
+// Returns the number of rows: those every flight reached.
+int SolveRangeCard(const Projectile& projectile, double RangeStep_yard, double MaxRange_yard, const RangeCardWind* Winds, int WindCount, RangeCard& Card);
+/* Arguments:
+      projectile:  A projectile that has been fired.  It is not modified: each flight flies a copy of it.
+      RangeStep_yard, MaxRange_yard:  As for SolveTable.
+      Winds:  The winds, WindCount of them.
+      Card:  Receives the card.  Its vectors keep their memory from one call to the next.
+*/
+
+#endif
@@ -0,0 +1,238 @@
+#include "ballistics.h"
+#include "integrator.h"
+#include "basicprojectile.h"
+
+#define EVENT_COUNT 5
+#define EVENT_BISECTIONS 50 // locates an event to 1e-15 of its step
+
+static const EProjectileEvent EventOrder[EVENT_COUNT] = { EVENT_LINEOFSIGHT, EVENT_TARGET, EVENT_TRANSONIC, EVENT_SUBSONIC, EVENT_GROUND };
+
+// An event's crossing function: it changes sign where the event happens.
+static double EventValue(const Projectile& projectile, EProjectileEvent Event, const double* State, double headwind_feet_sec)
+{
+   switch (Event)
+   {
+   case EVENT_LINEOFSIGHT:
+      return State[STATE_Y];
+   case EVENT_TARGET:
+      return State[STATE_X] - 3*projectile.TargetRange;
+   case EVENT_TRANSONIC:
+   case EVENT_SUBSONIC:
+      {
+         double airspeed = sqrt(State[STATE_VX]*State[STATE_VX]+State[STATE_VY]*State[STATE_VY]) + headwind_feet_sec;
+         return airspeed - (Event == EVENT_TRANSONIC ? 1.2 : 1) * projectile.SpeedOfSound;
+      }
+   case EVENT_GROUND:
+   default:
+      // The height above the ground: gravity points down along the projectile's axes.
+      return projectile.SightHeightOverGround - (State[STATE_X]*projectile.Gx + State[STATE_Y]*projectile.Gy) / fabs(GRAVITY);
+   }
+}
+
+// Whether an event is set up, and happens between two values of its crossing function.
+static bool EventBetween(const Projectile& projectile, EProjectileEvent Event, double Value, double NextValue)
+{
+   if (!(projectile.Events & Event))
+      return false;
+
+   switch (Event)
+   {
+   case EVENT_LINEOFSIGHT:
+      return (Value < 0) != (NextValue < 0);
+   case EVENT_TARGET:
+      return projectile.TargetRange > 0 && Value < 0 && NextValue >= 0;
+   case EVENT_GROUND:
+      return projectile.SightHeightOverGround > 0 && Value > 0 && NextValue <= 0;
+   default:
+      return Value >= 0 && NextValue < 0;
+   }
+}
+
+// An event within a step, at theta (0 to 1) of the step.
+struct StepEvent
+{
+   double Theta;
+   EProjectileEvent Event;
+
+   bool operator<(const StepEvent& other) const { return Theta < other.Theta; }
+};
+
+// The loop of Projectile::Advance, compiled per drag function for the trapezoidal step.
+struct AdvanceLoop
+{
+   typedef int Result;
+   Projectile& projectile;
+   double Seconds;
+   double headwind_mile_hr;
+   double crosswind_mile_hr;
+
+   // Whether the flight is over at State: too steep, past PathMaxRange, or on the ground.
+   bool Finished(const double* State)
+   {
+      if (fabs(State[STATE_VY]) > fabs(3*State[STATE_VX]))
+         return true;
+      if (State[STATE_X] > 3*projectile.PathMaxRange)
+         return true;
+      return projectile.SightHeightOverGround > 0 && EventValue(projectile, EVENT_GROUND, State, 0) <= 0;
+   }
+
+   template <class Drag> int Run()
+   {
+      double headwind_feet_sec = headwind_mile_hr*5280.0/3600.0;
+      DormandPrince integrator(projectile, projectile.Gx, projectile.Gy, headwind_feet_sec);
+      bool reporting = projectile.EventHandler && projectile.Events;
+
+      double State[STATE_SIZE] = { projectile.x, projectile.y, projectile.vx, projectile.vy };
+      double D[STATE_SIZE];
+      bool haveD = false;
+      if (Finished(State))
+         return 0;
+
+      double end = projectile.t + Seconds;
+      while (projectile.t < end)
+      {
+         double remaining = end - projectile.t;
+         double NextState[STATE_SIZE];
+         double NextD[STATE_SIZE];
+         bool haveNextD = false;
+         double taken;
+
+         if (projectile.Integrator == RK45)
+         {
+            if (!haveD)
+               integrator.Derivative(State, D);
+            haveD = true;
+
+            double h = (projectile.AdvanceStep > 0) ? projectile.AdvanceStep : 50 / projectile.MuzzleVelocity;
+            bool cut = h > remaining;
+            if (cut)
+               h = remaining;
+
+            double proposal = h;
+            taken = integrator.Step(proposal, State, D, NextState, NextD);
+            haveNextD = true;
+
+            // Keep the error control's proposal, unless the step was only cut short by the end of the tick.
+            if (!cut || taken < h)
+               projectile.AdvanceStep = proposal;
+
+            projectile.x = NextState[STATE_X];
+            projectile.y = NextState[STATE_Y];
+            projectile.vx = NextState[STATE_VX];
+            projectile.vy = NextState[STATE_VY];
+         }
+         else
+         {
+            double v = sqrt(State[STATE_VX]*State[STATE_VX]+State[STATE_VY]*State[STATE_VY]);
+            taken = (0.5 / v < remaining) ? 0.5 / v : remaining;
+
+            double dt = taken;
+            TrapezoidalStep<Drag, false>(projectile, dt, headwind_mile_hr, crosswind_mile_hr);
+
+            NextState[STATE_X] = projectile.x;
+            NextState[STATE_Y] = projectile.y;
+            NextState[STATE_VX] = projectile.vx;
+            NextState[STATE_VY] = projectile.vy;
+         }
+
+         double time = projectile.t;
+         projectile.t = (taken == remaining) ? end : time + taken;
+
+         // The events of this step, in the order they happened.
+         if (reporting || projectile.SightHeightOverGround > 0)
+         {
+            StepEvent found[EVENT_COUNT];
+            int count = 0;
+            for (int e = 0; e < EVENT_COUNT; e++)
+            {
+               EProjectileEvent event = EventOrder[e];
+               if (!reporting && event != EVENT_GROUND)
+                  continue;
+               if (!EventBetween(projectile, event, EventValue(projectile, event, State, headwind_feet_sec), EventValue(projectile, event, NextState, headwind_feet_sec)))
+                  continue;
+
+               if (!haveD)
+                  integrator.Derivative(State, D);
+               if (!haveNextD)
+                  integrator.Derivative(NextState, NextD);
+               haveD = haveNextD = true;
+
+               // Bisect the dense output for the crossing.
+               double low = 0, high = 1;
+               bool below = EventValue(projectile, event, State, headwind_feet_sec) < 0;
+               for (int n = 0; n < EVENT_BISECTIONS; n++)
+               {
+                  double theta = (low + high) / 2;
+                  double s[STATE_SIZE];
+                  InterpolateState(State, D, NextState, NextD, taken, theta, s);
+                  if ((EventValue(projectile, event, s, headwind_feet_sec) < 0) == below)
+                     low = theta;
+                  else
+                     high = theta;
+               }
+
+               found[count].Theta = high;
+               found[count].Event = event;
+               count++;
+            }
+            // An insertion sort: there are only a few, and it keeps events at the same theta in EventOrder.
+            for (int i = 1; i < count; i++)
+            {
+               StepEvent next = found[i];
+               int j = i;
+               for (; j > 0 && next < found[j-1]; j--)
+                  found[j] = found[j-1];
+               found[j] = next;
+            }
+
+            for (int i = 0; i < count; i++)
+            {
+               double s[STATE_SIZE];
+               InterpolateState(State, D, NextState, NextD, taken, found[i].Theta, s);
+               double eventTime = time + found[i].Theta * taken;
+
+               if (reporting && (projectile.Events & found[i].Event))
+               {
+                  ProjectileEvent event;
+                  event.Event = found[i].Event;
+                  event.Time = eventTime;
+                  event.Range = s[STATE_X]/3;
+                  event.Path = s[STATE_Y]*12;
+                  event.Windage = projectile.WindageCorrection(crosswind_mile_hr, projectile.MuzzleVelocity, s[STATE_X], eventTime);
+                  event.Velocity = sqrt(s[STATE_VX]*s[STATE_VX]+s[STATE_VY]*s[STATE_VY]);
+                  projectile.EventHandler(event, projectile.EventContext);
+               }
+
+               // The flight stops where it hits the ground.
+               if (found[i].Event == EVENT_GROUND)
+               {
+                  projectile.x = s[STATE_X];
+                  projectile.y = s[STATE_Y];
+                  projectile.vx = s[STATE_VX];
+                  projectile.vy = s[STATE_VY];
+                  projectile.t = eventTime;
+                  return 0;
+               }
+            }
+         }
+
+         for (int i = 0; i < STATE_SIZE; i++)
+         {
+            State[i] = NextState[i];
+            D[i] = NextD[i];
+         }
+         haveD = haveNextD;
+
+         if (Finished(State))
+            return 0;
+      }
+
+      return 1;
+   }
+};
+
+int Projectile::Advance(double Seconds, double headwind_mile_hr, double crosswind_mile_hr)
+{
+   AdvanceLoop loop = { *this, Seconds, headwind_mile_hr, crosswind_mile_hr };
+   return DispatchDrag(*this, loop);
+}
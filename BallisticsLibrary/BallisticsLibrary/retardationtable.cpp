@@ -0,0 +1,45 @@
+#include "retardationtable.h"
+
+RetardationTable::RetardationTable(EDragFunction DragFunction, double DragCoefficient, double Step)
+{
+   this->DragFunction = DragFunction;
+   this->DragCoefficient = DragCoefficient;
+   this->Step = Step;
+   this->InvStep = 1/Step;
+
+   // One extra cell absorbs rounding of Velocity * InvStep just below DRAG_MAXVELOCITY.
+   CellCount = (int)ceil(DRAG_MAXVELOCITY * InvStep) + 1;
+   Value = new double[CellCount];
+   Slope = new double[CellCount];
+
+   const DragModel* model = GetDragModel(DragFunction);
+
+   for (int k = 0; k < CellCount; k++)
+   {
+      if (!model)
+      {
+         Value[k] = -1;
+         Slope[k] = 0;
+         continue;
+      }
+
+      double v0 = k * Step;
+      double v1 = v0 + Step;
+      double middle = v0 + Step/2;
+      if (middle >= DRAG_MAXVELOCITY)
+         middle = DRAG_MAXVELOCITY - Step/2;
+
+      const DragBand& band = FindDragBand(model, middle);
+      double r0 = band.A * pow(v0, band.M) / DragCoefficient;
+      double r1 = band.A * pow(v1, band.M) / DragCoefficient;
+
+      Value[k] = r0;
+      Slope[k] = r1 - r0;
+   }
+}
+
+RetardationTable::~RetardationTable()
+{
+   delete[] Value;
+   delete[] Slope;
+}
@@ -0,0 +1,66 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _RETARDATIONTABLE_
+#define _RETARDATIONTABLE_
+
+#include "drag.h"
+
+#define RETARDATIONTABLE_STEP 0.5 // Default grid step, in ft/s: 20000 cells, 320 KB per table.
+
+// A precomputed drag retardation curve for one drag function and drag coefficient, sampled on a
+// uniform velocity grid over the domain of DragRetardationVelocity (0 to DRAG_MAXVELOCITY ft/s).
+// Lookup costs one multiply, one truncation and one linear interpolation: no pow, no division.
+//
+// Each cell interpolates between the two ends of the band that covers its middle, so band edges
+// that fall on grid points (all the built-in G functions at the default step) add no error,
+// apart from the edge velocity itself, where DragRetardationVelocity takes the lower band.
+// At the default step, the relative error against DragRetardationVelocity is at most:
+//    2e-6 from 1000 ft/s up (the transonic bands, where M reaches 7.9, are the worst case),
+//    1e-5 from 100 ft/s up,
+//    1e-4 from 30 ft/s up,
+// and it grows as (Step/Velocity)^2 below that.  The error shrinks with the square of Step.
+//
+// To use it for a projectile, point Projectile::pRetardationTable at a table built for the
+// projectile's DragFunction and (atmosphere corrected) DragCoefficient.  A table can be shared
+// by any number of projectiles and threads; it is never modified after construction.
+
+class RetardationTable
+{
+public:
+   EDragFunction DragFunction;
+   double DragCoefficient;
+   double Step;    // grid step, in ft/s
+   double InvStep;
+   int CellCount;
+
+   double* Value;  // retardation at the low end of each cell
+   double* Slope;  // change in retardation across each cell
+
+   RetardationTable(EDragFunction DragFunction, double DragCoefficient, double Step = RETARDATIONTABLE_STEP);
+   /* Arguments:
+         DragFunction:  The drag function to tabulate.  Empty drag models give a table of -1.
+         DragCoefficient:  The coefficient of drag for the projectile for the given drag function.
+         Step:  The grid step, in ft/s.  Memory use is 16 * DRAG_MAXVELOCITY / Step bytes.
+   */
+   ~RetardationTable();
+
+   // The drag retardation velocity, in ft/s per second, or -1 out of range, like DragRetardationVelocity.
+   double Lookup(double Velocity) const
+   {
+      if (!(Velocity > 0 && Velocity < DRAG_MAXVELOCITY))
+         return -1;
+
+      double u = Velocity * InvStep;
+      int k = (int)u;
+      return Value[k] + (u - k) * Slope[k];
+   }
+
+private:
+   // Copying would share (and double free) the arrays.
+   RetardationTable(const RetardationTable&);
+   RetardationTable& operator=(const RetardationTable&);
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "solutioncache.h"
+
+#include <string.h>
+
+SolutionQuantum::SolutionQuantum()
+{
+   DragCoefficient = 0.001;
+   MuzzleVelocity = 1;
+   SightHeightOverBore = 0.01;
+
+   Altitude_feet = 10;
+   Barometer_hg = 0.01;
+   Temperature_f = 0.5;
+   RelativeHumidity = 0.01;
+
+   ZeroRange_yard = 1;
+   yIntercept_inch = 0.01;
+
+   BoreAngle = 0.1;
+   WindSpeed_mile_hr = 0.1;
+   WindAngle = 1;
+}
+
+SolutionCache::SolutionCache(int Capacity, const SolutionQuantum& Quantum)
+{
+   this->Capacity = Capacity < 1 ? 1 : Capacity;
+   this->Quantum = Quantum;
+
+   SolutionHits = 0;
+   SolutionMisses = 0;
+   ZeroHitCount = 0;
+   ZeroMissCount = 0;
+}
+
+// Rounds a value to a whole number of quanta, or leaves it as it is for a quantum of 0.
+static double Round(double Value, double Quantum)
+{
+   return Quantum > 0 ? floor(Value/Quantum + 0.5) * Quantum : Value;
+}
+
+SolutionRequest SolutionCache::Quantize(const SolutionRequest& Request) const
+{
+   SolutionRequest q = Request;
+   q.DragCoefficient = Round(Request.DragCoefficient, Quantum.DragCoefficient);
+   q.MuzzleVelocity = Round(Request.MuzzleVelocity, Quantum.MuzzleVelocity);
+   q.SightHeightOverBore = Round(Request.SightHeightOverBore, Quantum.SightHeightOverBore);
+   q.Altitude_feet = Round(Request.Altitude_feet, Quantum.Altitude_feet);
+   q.Barometer_hg = Round(Request.Barometer_hg, Quantum.Barometer_hg);
+   q.Temperature_f = Round(Request.Temperature_f, Quantum.Temperature_f);
+   q.RelativeHumidity = Round(Request.RelativeHumidity, Quantum.RelativeHumidity);
+   q.ZeroRange_yard = Round(Request.ZeroRange_yard, Quantum.ZeroRange_yard);
+   q.yIntercept_inch = Round(Request.yIntercept_inch, Quantum.yIntercept_inch);
+   q.BoreAngle = Round(Request.BoreAngle, Quantum.BoreAngle);
+   q.WindSpeed_mile_hr = Round(Request.WindSpeed_mile_hr, Quantum.WindSpeed_mile_hr);
+   q.WindAngle = Round(Request.WindAngle, Quantum.WindAngle);
+   return q;
+}
+
+// A key value: the exact bits of a quantized input, with -0 folded into 0.
+static long long KeyValue(double Value)
+{
+   if (Value == 0)
+      Value = 0;
+
+   long long bits;
+   memcpy(&bits, &Value, sizeof(bits));
+   return bits;
+}
+
+SolutionCache::Key SolutionCache::ZeroKey(const SolutionRequest& q) const
+{
+   Key key;
+   key.Count = 0;
+   key.Values[key.Count++] = q.DragFunction;
+   key.Values[key.Count++] = q.Integrator;
+   key.Values[key.Count++] = KeyValue(q.DragCoefficient);
+   key.Values[key.Count++] = KeyValue(q.MuzzleVelocity);
+   key.Values[key.Count++] = KeyValue(q.SightHeightOverBore);
+   key.Values[key.Count++] = KeyValue(q.Altitude_feet);
+   key.Values[key.Count++] = KeyValue(q.Barometer_hg);
+   key.Values[key.Count++] = KeyValue(q.Temperature_f);
+   key.Values[key.Count++] = KeyValue(q.RelativeHumidity);
+   key.Values[key.Count++] = KeyValue(q.ZeroRange_yard);
+   key.Values[key.Count++] = KeyValue(q.yIntercept_inch);
+   return key;
+}
+
+SolutionCache::Key SolutionCache::SolutionKey(const SolutionRequest& q) const
+{
+   Key key = ZeroKey(q);
+   key.Values[key.Count++] = KeyValue(q.BoreAngle);
+   key.Values[key.Count++] = KeyValue(q.WindSpeed_mile_hr);
+   key.Values[key.Count++] = KeyValue(q.WindAngle);
+   key.Values[key.Count++] = KeyValue(q.RangeStep_yard);
+   key.Values[key.Count++] = KeyValue(q.MaxRange_yard);
+   key.Values[key.Count++] = q.Columns;
+   return key;
+}
+
+bool SolutionCache::Key::operator==(const Key& other) const
+{
+   return Count == other.Count && memcmp(Values, other.Values, Count * sizeof(Values[0])) == 0;
+}
+
+size_t SolutionCache::KeyHash::operator()(const Key& key) const
+{
+   // FNV-1a over the values, a 64 bit word at a time, then mixed down.
+   unsigned long long h = 14695981039346656037ULL;
+   for (int i = 0; i < key.Count; i++)
+      h = (h ^ (unsigned long long)key.Values[i]) * 1099511628211ULL;
+   return (size_t)(h ^ (h >> 32));
+}
+
+template <class Value>
+const Value* SolutionCache::Lru<Value>::Find(const Key& key)
+{
+   typename std::unordered_map<Key, typename List::iterator, KeyHash>::iterator found = Index.find(key);
+   if (found == Index.end())
+      return NULL;
+
+   // Move it to the front: it is now the most recently used.
+   Entries.splice(Entries.begin(), Entries, found->second);
+   return &found->second->second;
+}
+
+template <class Value>
+void SolutionCache::Lru<Value>::Insert(const Key& key, const Value& value, int Capacity)
+{
+   if (Find(key))
+      return;
+
+   Entries.push_front(std::make_pair(key, value));
+   Index[key] = Entries.begin();
+
+   while ((int)Entries.size() > Capacity)
+   {
+      Index.erase(Entries.back().first);
+      Entries.pop_back();
+   }
+}
+
+std::shared_ptr<const SolutionResult> SolutionCache::Solve(const SolutionRequest& Request)
+{
+   SolutionRequest q = Quantize(Request);
+   Key solutionKey = SolutionKey(q);
+   Key zeroKey = ZeroKey(q);
+
+   std::shared_ptr<SolutionResult> result(new SolutionResult);
+   bool zeroed = false;
+   {
+      std::lock_guard<std::mutex> lock(Lock);
+
+      const std::shared_ptr<const SolutionResult>* cached = Solutions.Find(solutionKey);
+      if (cached)
+      {
+         SolutionHits++;
+         return *cached;
+      }
+      SolutionMisses++;
+
+      const Zero* zero = Zeros.Find(zeroKey);
+      if (zero)
+      {
+         ZeroHitCount++;
+         result->DragCoefficient = zero->DragCoefficient;
+         result->SightToBoreAngle = zero->SightToBoreAngle;
+         zeroed = true;
+      }
+      else
+         ZeroMissCount++;
+   }
+
+   Projectile scratch(1, G1, 1, 0);
+   if (!zeroed)
+      BatchSolver::SolveZero(q, scratch, *result);
+   BatchSolver::SolveZeroed(q, scratch, *result);
+
+   std::lock_guard<std::mutex> lock(Lock);
+
+   if (!zeroed)
+   {
+      Zero zero = { result->DragCoefficient, result->SightToBoreAngle };
+      Zeros.Insert(zeroKey, zero, Capacity);
+   }
+
+   // Another thread may have solved the same request meanwhile: share its solution.
+   const std::shared_ptr<const SolutionResult>* cached = Solutions.Find(solutionKey);
+   if (cached)
+      return *cached;
+
+   std::shared_ptr<const SolutionResult> solution = result;
+   Solutions.Insert(solutionKey, solution, Capacity);
+   return solution;
+}
+
+void SolutionCache::Clear()
+{
+   std::lock_guard<std::mutex> lock(Lock);
+   Zeros.Clear();
+   Solutions.Clear();
+}
+
+int SolutionCache::Size() const
+{
+   std::lock_guard<std::mutex> lock(Lock);
+   return (int)Solutions.Entries.size();
+}
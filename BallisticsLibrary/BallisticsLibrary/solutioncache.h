@@ -0,0 +1,128 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _SOLUTIONCACHE_
+#define _SOLUTIONCACHE_
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "batchsolver.h"
+
+// The resolution SolutionCache rounds each input of a SolutionRequest to before looking it up.
+// Requests that round to the same values share a solution.  A quantum of 0 keeps the input exact.
+struct SolutionQuantum
+{
+   double DragCoefficient;       // default 0.001
+   double MuzzleVelocity;        // default 1 ft/s
+   double SightHeightOverBore;   // default 0.01 inches
+
+   double Altitude_feet;         // default 10 feet
+   double Barometer_hg;          // default 0.01 in Hg
+   double Temperature_f;         // default 0.5 degrees F
+   double RelativeHumidity;      // default 0.01
+
+   double ZeroRange_yard;        // default 1 yard
+   double yIntercept_inch;       // default 0.01 inches
+
+   double BoreAngle;             // default 0.1 degrees
+   double WindSpeed_mile_hr;     // default 0.1 mi/hr
+   double WindAngle;             // default 1 degree
+
+   SolutionQuantum();
+};
+
+// A memo of solved SolutionRequests, in front of BatchSolver::SolveOne.
+//
+// Each request is first rounded to the quantum, and it is the rounded request that gets solved, so a
+// cached solution is the same whichever request first filled it in.  The table's RangeStep_yard,
+// MaxRange_yard and Columns, the drag function and the integrator are always matched exactly.
+//
+// There are two levels, each bounded to Capacity entries and evicted least recently used first:
+//    zeros, keyed on the projectile, the atmosphere and the zero, cache CalculateSightToBoreAngle;
+//    solutions, keyed on all of the request, cache the whole result, zero and table.
+// So a change of wind or shooting angle alone still skips the zero search.
+//
+// Lookups are thread-safe.  The lock is not held while solving, so a miss does not hold up other
+// threads; two threads that miss on the same request at once both solve it, and the first one kept wins.
+// Solutions are shared, immutable, and stay valid after they are evicted.
+class SolutionCache
+{
+public:
+   SolutionCache(int Capacity, const SolutionQuantum& Quantum = SolutionQuantum());
+   /* Arguments:
+         Capacity:  The most solutions kept, and separately, the most zeros kept.  At least 1.
+         Quantum:  The resolution of the inputs.
+   */
+
+   // Returns the solution to Request, from the cache if it holds one, solving it on the calling thread if not.
+   std::shared_ptr<const SolutionResult> Solve(const SolutionRequest& Request);
+
+   // Rounds a request to the quantum, as Solve does before solving it.
+   SolutionRequest Quantize(const SolutionRequest& Request) const;
+
+   // Empties the cache.  The counters are kept.
+   void Clear();
+
+   long long Hits() const { return SolutionHits; }     // Solve calls answered from the cache
+   long long Misses() const { return SolutionMisses; } // Solve calls that solved their request
+   long long ZeroHits() const { return ZeroHitCount; } // misses whose zero was cached
+   long long ZeroMisses() const { return ZeroMissCount; }
+   int Size() const;                                   // solutions held
+
+private:
+   // A quantized request: the exact bits of each of its inputs.
+   struct Key
+   {
+      long long Values[17];
+      int Count;
+
+      bool operator==(const Key& other) const;
+   };
+   struct KeyHash
+   {
+      size_t operator()(const Key& key) const;
+   };
+
+   // A least recently used map: the list holds the entries, most recent first, and the map indexes it.
+   template <class Value>
+   struct Lru
+   {
+      typedef std::list<std::pair<Key, Value> > List;
+      List Entries;
+      std::unordered_map<Key, typename List::iterator, KeyHash> Index;
+
+      const Value* Find(const Key& key);
+      void Insert(const Key& key, const Value& value, int Capacity);
+      void Clear() { Entries.clear(); Index.clear(); }
+   };
+
+   struct Zero
+   {
+      double DragCoefficient;
+      double SightToBoreAngle;
+   };
+
+   int Capacity;
+   SolutionQuantum Quantum;
+
+   mutable std::mutex Lock; // guards the two caches; the counters are only changed under it
+   Lru<Zero> Zeros;
+   Lru<std::shared_ptr<const SolutionResult> > Solutions;
+   std::atomic<long long> SolutionHits;
+   std::atomic<long long> SolutionMisses;
+   std::atomic<long long> ZeroHitCount;
+   std::atomic<long long> ZeroMissCount;
+
+   Key ZeroKey(const SolutionRequest& Quantized) const;
+   Key SolutionKey(const SolutionRequest& Quantized) const;
+
+   SolutionCache(const SolutionCache&) = delete;
+   SolutionCache& operator=(const SolutionCache&) = delete;
+};
+
+#endif
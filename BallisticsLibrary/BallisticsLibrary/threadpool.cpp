@@ -0,0 +1,120 @@
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(int ThreadCount)
+{
+   if (ThreadCount <= 0)
+      ThreadCount = (int)std::thread::hardware_concurrency();
+   if (ThreadCount <= 0)
+      ThreadCount = 1;
+
+   Task = NULL;
+   Context = NULL;
+   Generation = 0;
+   Stopping = false;
+   Remaining = 0;
+
+   for (int i = 0; i < ThreadCount; i++)
+      Queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue));
+   for (int i = 0; i < ThreadCount; i++)
+      Threads.push_back(std::thread(&ThreadPool::Worker, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+   {
+      std::lock_guard<std::mutex> lock(Lock);
+      Stopping = true;
+   }
+   Wake.notify_all();
+
+   for (size_t i = 0; i < Threads.size(); i++)
+      Threads[i].join();
+}
+
+void ThreadPool::Run(int TaskCount, ThreadPoolTask Task, void* Context)
+{
+   if (TaskCount <= 0)
+      return;
+
+   std::lock_guard<std::mutex> run(RunLock);
+   std::unique_lock<std::mutex> lock(Lock);
+
+   this->Task = Task;
+   this->Context = Context;
+   Remaining = TaskCount;
+
+   // Deal the tasks out in contiguous blocks, so neighbouring tasks stay on one thread until stolen.
+   // A worker still finishing the previous Run may take one of these as soon as it is queued, so
+   // Task and Context are set first, and workers read them after taking a task from a queue.
+   int workers = ThreadCount();
+   for (int w = 0; w < workers; w++)
+   {
+      std::lock_guard<std::mutex> queue(Queues[w]->Lock);
+      for (int i = (int)((long long)TaskCount*w/workers); i < (int)((long long)TaskCount*(w+1)/workers); i++)
+         Queues[w]->Tasks.push_back(i);
+   }
+
+   Generation++;
+   Wake.notify_all();
+
+   Finished.wait(lock, [this] { return Remaining == 0; });
+}
+
+bool ThreadPool::NextTask(int Worker, int& Index)
+{
+   // Our own tasks first, newest first...
+   {
+      WorkerQueue& own = *Queues[Worker];
+      std::lock_guard<std::mutex> lock(own.Lock);
+      if (!own.Tasks.empty())
+      {
+         Index = own.Tasks.back();
+         own.Tasks.pop_back();
+         return true;
+      }
+   }
+
+   // ...then the oldest task of the next worker that has any.
+   int workers = ThreadCount();
+   for (int n = 1; n < workers; n++)
+   {
+      WorkerQueue& victim = *Queues[(Worker+n) % workers];
+      std::lock_guard<std::mutex> lock(victim.Lock);
+      if (!victim.Tasks.empty())
+      {
+         Index = victim.Tasks.front();
+         victim.Tasks.pop_front();
+         return true;
+      }
+   }
+
+   return false;
+}
+
+void ThreadPool::Worker(int Worker)
+{
+   unsigned seen = 0;
+
+   for (;;)
+   {
+      {
+         std::unique_lock<std::mutex> lock(Lock);
+         Wake.wait(lock, [&] { return Stopping || Generation != seen; });
+         if (Stopping)
+            return;
+         seen = Generation;
+      }
+
+      int index;
+      while (NextTask(Worker, index))
+      {
+         Task(index, Worker, Context);
+
+         if (--Remaining == 0)
+         {
+            std::lock_guard<std::mutex> lock(Lock);
+            Finished.notify_all();
+         }
+      }
+   }
+}
@@ -0,0 +1,65 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _THREADPOOL_
+#define _THREADPOOL_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A task run by ThreadPool::Run: Index is the task's number (0 to TaskCount-1), Worker is the number
+// of the thread running it (0 to ThreadCount()-1), for per-thread scratch, and Context is Run's Context.
+typedef void (*ThreadPoolTask)(int Index, int Worker, void* Context);
+
+// A fixed set of worker threads with one task deque each.  Run deals the tasks out in contiguous
+// blocks, one block per worker.  Each worker takes its own tasks from the back of its deque, and when
+// it runs out, steals from the front of the others', so uneven tasks still keep every thread busy.
+class ThreadPool
+{
+public:
+   ThreadPool(int ThreadCount = 0);
+   /* Arguments:
+         ThreadCount:  The number of worker threads, or 0 for one per hardware thread.
+   */
+   ~ThreadPool();
+
+   int ThreadCount() const { return (int)Threads.size(); }
+
+   // Runs Task for every index from 0 to TaskCount-1 and waits for all of them to finish.
+   // Calls from several threads at once are run one after the other.
+   void Run(int TaskCount, ThreadPoolTask Task, void* Context);
+
+private:
+   struct WorkerQueue
+   {
+      std::mutex Lock;
+      std::deque<int> Tasks;
+   };
+
+   std::vector<std::thread> Threads;
+   std::vector<std::unique_ptr<WorkerQueue> > Queues;
+
+   std::mutex RunLock;               // serializes Run
+   std::mutex Lock;                  // guards the fields below
+   std::condition_variable Wake;     // a new Run, or shutdown
+   std::condition_variable Finished; // the last task of a Run is done
+   ThreadPoolTask Task;
+   void* Context;
+   unsigned Generation;              // counts Runs, so workers can tell a new one from a spurious wakeup
+   bool Stopping;
+   std::atomic<int> Remaining;       // tasks of the current Run not finished yet
+
+   void Worker(int Worker);
+   bool NextTask(int Worker, int& Index);
+
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+#endif
@@ -0,0 +1,327 @@
+#include "trajectoryfile.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define TRAJECTORYFILE_COLUMNS 9
+
+// The bytes a column of Rows values takes in an encoding, padded to 8 bytes.
+static size_t ColumnSize(int Encoding, int Rows)
+{
+   size_t size;
+   switch (Encoding)
+   {
+   case TRAJECTORY_FLOAT64: size = 8 * (size_t)Rows; break;
+   case TRAJECTORY_FLOAT32: size = 4 * (size_t)Rows; break;
+   default: size = 8 * (size_t)((Rows + TRAJECTORYFILE_BLOCK-1) / TRAJECTORYFILE_BLOCK) + 4 * (size_t)Rows; break;
+   }
+   return (size + 7) & ~(size_t)7;
+}
+
+// The EPathColumn bit number of a column.
+static int ColumnBit(EPathColumn Column)
+{
+   int bit = 0;
+   while (bit < TRAJECTORYFILE_COLUMNS && !(Column & (1 << bit)))
+      bit++;
+   return bit;
+}
+
+std::vector<unsigned char> EncodeTrajectoryFile(const SolutionRequest& Request, const SolutionResult& Result, ETrajectoryEncoding Encoding)
+{
+   TrajectoryFileHeader header;
+   memset(&header, 0, sizeof(header));
+   header.Magic = TRAJECTORYFILE_MAGIC;
+   header.Version = TRAJECTORYFILE_VERSION;
+   header.HeaderSize = sizeof(TrajectoryFileHeader);
+   header.Encoding = Encoding;
+   header.Columns = Request.Columns & PATH_ALL;
+   header.RowCount = Result.RowCount;
+
+   header.DragFunction = Request.DragFunction;
+   header.Integrator = Request.Integrator;
+   header.DragCoefficient = Request.DragCoefficient;
+   header.CorrectedDragCoefficient = Result.DragCoefficient;
+   header.MuzzleVelocity = Request.MuzzleVelocity;
+   header.SightHeightOverBore = Request.SightHeightOverBore;
+   header.Altitude_feet = Request.Altitude_feet;
+   header.Barometer_hg = Request.Barometer_hg;
+   header.Temperature_f = Request.Temperature_f;
+   header.RelativeHumidity = Request.RelativeHumidity;
+   header.ZeroRange_yard = Request.ZeroRange_yard;
+   header.yIntercept_inch = Request.yIntercept_inch;
+   header.SightToBoreAngle = Result.SightToBoreAngle;
+   header.BoreAngle = Request.BoreAngle;
+   header.WindSpeed_mile_hr = Request.WindSpeed_mile_hr;
+   header.WindAngle = Request.WindAngle;
+   header.RangeStep_yard = Request.RangeStep_yard;
+
+   size_t size = sizeof(header);
+   for (int bit = 0; bit < TRAJECTORYFILE_COLUMNS; bit++)
+   {
+      if (header.Columns & (1 << bit))
+      {
+         header.ColumnOffset[bit] = size;
+         size += ColumnSize(Encoding, header.RowCount);
+      }
+   }
+
+   std::vector<unsigned char> file(size, 0);
+   memcpy(file.data(), &header, sizeof(header));
+
+   // The table is packed row by row, with the stored columns in bit order; the file, column by column.
+   int stride = PathColumnCount(header.Columns);
+   int column = 0;
+   for (int bit = 0; bit < TRAJECTORYFILE_COLUMNS; bit++)
+   {
+      if (!(header.Columns & (1 << bit)))
+         continue;
+
+      unsigned char* out = file.data() + header.ColumnOffset[bit];
+      int blocks = (header.RowCount + TRAJECTORYFILE_BLOCK-1) / TRAJECTORYFILE_BLOCK;
+      for (int row = 0; row < header.RowCount; row++)
+      {
+         double value = Result.Table[(size_t)row*stride + column];
+         if (Encoding == TRAJECTORY_FLOAT64)
+            memcpy(out + 8*(size_t)row, &value, 8);
+         else if (Encoding == TRAJECTORY_FLOAT32)
+         {
+            float f = (float)value;
+            memcpy(out + 4*(size_t)row, &f, 4);
+         }
+         else
+         {
+            int block = row / TRAJECTORYFILE_BLOCK;
+            double base = Result.Table[(size_t)block*TRAJECTORYFILE_BLOCK*stride + column];
+            if (row % TRAJECTORYFILE_BLOCK == 0)
+               memcpy(out + 8*(size_t)block, &base, 8);
+
+            float delta = (float)(value - base);
+            memcpy(out + 8*(size_t)blocks + 4*(size_t)row, &delta, 4);
+         }
+      }
+      column++;
+   }
+
+   return file;
+}
+
+int WriteTrajectoryFile(const char* Path, const SolutionRequest& Request, const SolutionResult& Result, ETrajectoryEncoding Encoding)
+{
+   std::vector<unsigned char> file = EncodeTrajectoryFile(Request, Result, Encoding);
+
+   FILE* f = fopen(Path, "wb");
+   if (!f)
+      return 0;
+
+   int written = fwrite(file.data(), 1, file.size(), f) == file.size();
+   return (fclose(f) == 0) && written;
+}
+
+// The header of a closed TrajectoryFile: no rows, no columns.
+static const TrajectoryFileHeader EmptyHeader = {};
+
+TrajectoryFile::TrajectoryFile()
+{
+   Data = NULL;
+   Size = 0;
+   pHeader = &EmptyHeader;
+   Mapped = false;
+   MapHandle = NULL;
+}
+
+TrajectoryFile::~TrajectoryFile()
+{
+   Close();
+}
+
+int TrajectoryFile::Open(const void* Data, size_t Size)
+{
+   Close();
+
+   TrajectoryFileHeader header;
+   if (Size < sizeof(header))
+      return 0;
+   memcpy(&header, Data, sizeof(header));
+
+   if (header.Magic != TRAJECTORYFILE_MAGIC || header.Version != TRAJECTORYFILE_VERSION || header.HeaderSize != sizeof(header))
+      return 0;
+   if (header.Encoding < TRAJECTORY_FLOAT64 || header.Encoding > TRAJECTORY_DELTA32 || header.RowCount < 0 || (header.Columns & ~PATH_ALL))
+      return 0;
+
+   // Every stored column must be aligned and lie within the file.
+   size_t columnSize = ColumnSize(header.Encoding, header.RowCount);
+   for (int bit = 0; bit < TRAJECTORYFILE_COLUMNS; bit++)
+   {
+      if (!(header.Columns & (1 << bit)))
+         continue;
+
+      unsigned long long offset = header.ColumnOffset[bit];
+      if (offset < sizeof(header) || offset % 8 || offset > Size || Size - offset < columnSize)
+         return 0;
+   }
+
+   this->Data = (const unsigned char*)Data;
+   this->Size = Size;
+   pHeader = (const TrajectoryFileHeader*)Data;
+   return 1;
+}
+
+int TrajectoryFile::Open(const char* Path)
+{
+   Close();
+
+#if defined(_WIN32)
+   HANDLE file = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+   if (file == INVALID_HANDLE_VALUE)
+      return 0;
+
+   LARGE_INTEGER size;
+   HANDLE mapping = NULL;
+   const void* data = NULL;
+   if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+      mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+   if (mapping)
+      data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+   CloseHandle(file);
+
+   if (!data || !Open(data, (size_t)size.QuadPart))
+   {
+      if (data)
+         UnmapViewOfFile(data);
+      if (mapping)
+         CloseHandle(mapping);
+      return 0;
+   }
+   MapHandle = mapping;
+#else
+   int file = open(Path, O_RDONLY);
+   if (file < 0)
+      return 0;
+
+   struct stat info;
+   void* data = MAP_FAILED;
+   if (fstat(file, &info) == 0 && info.st_size > 0)
+      data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, file, 0);
+   close(file);
+
+   if (data == MAP_FAILED)
+      return 0;
+   if (!Open(data, (size_t)info.st_size))
+   {
+      munmap(data, (size_t)info.st_size);
+      return 0;
+   }
+#endif
+
+   Mapped = true;
+   return 1;
+}
+
+void TrajectoryFile::Close()
+{
+   if (Mapped)
+   {
+#if defined(_WIN32)
+      UnmapViewOfFile(Data);
+      CloseHandle((HANDLE)MapHandle);
+#else
+      munmap((void*)Data, Size);
+#endif
+   }
+
+   Data = NULL;
+   Size = 0;
+   pHeader = &EmptyHeader;
+   Mapped = false;
+   MapHandle = NULL;
+}
+
+double TrajectoryFile::Value(int Row, EPathColumn Column) const
+{
+   int bit = ColumnBit(Column);
+   if (!(pHeader->Columns & Column) || bit >= TRAJECTORYFILE_COLUMNS)
+      return 0;
+
+   const unsigned char* column = Data + pHeader->ColumnOffset[bit];
+   switch (pHeader->Encoding)
+   {
+   case TRAJECTORY_FLOAT64:
+      {
+         double value;
+         memcpy(&value, column + 8*(size_t)Row, 8);
+         return value;
+      }
+   case TRAJECTORY_FLOAT32:
+      {
+         float value;
+         memcpy(&value, column + 4*(size_t)Row, 4);
+         return value;
+      }
+   default:
+      {
+         int blocks = (pHeader->RowCount + TRAJECTORYFILE_BLOCK-1) / TRAJECTORYFILE_BLOCK;
+         double base;
+         float delta;
+         memcpy(&base, column + 8*(size_t)(Row / TRAJECTORYFILE_BLOCK), 8);
+         memcpy(&delta, column + 8*(size_t)blocks + 4*(size_t)Row, 4);
+         return base + delta;
+      }
+   }
+}
+
+// The ProjectilePath fields, in EPathColumn bit order.
+static double ProjectilePath::* const RowFields[TRAJECTORYFILE_COLUMNS] =
+{
+   &ProjectilePath::Range,
+   &ProjectilePath::Path,
+   &ProjectilePath::MOA,
+   &ProjectilePath::Time,
+   &ProjectilePath::Windage,
+   &ProjectilePath::WindageMOA,
+   &ProjectilePath::Velocity,
+   &ProjectilePath::Vx,
+   &ProjectilePath::Vy
+};
+
+void TrajectoryFile::GetRow(int Row, ProjectilePath& Out) const
+{
+   for (int bit = 0; bit < TRAJECTORYFILE_COLUMNS; bit++)
+      Out.*RowFields[bit] = Value(Row, (EPathColumn)(1 << bit));
+}
+
+int TrajectoryFile::Interpolate(double Range_yard, ProjectilePath& Out) const
+{
+   memset(&Out, 0, sizeof(Out));
+
+   double u = Range_yard / pHeader->RangeStep_yard;
+   if (!(u >= 0 && u <= pHeader->RowCount-1))
+      return 0;
+
+   int row = (int)u;
+   if (row == pHeader->RowCount-1)
+      row--;
+   if (row < 0)
+   {
+      // A table of one row, asked for its one range.
+      GetRow(0, Out);
+      return 1;
+   }
+
+   double f = u - row;
+   for (int bit = 0; bit < TRAJECTORYFILE_COLUMNS; bit++)
+   {
+      EPathColumn column = (EPathColumn)(1 << bit);
+      if (pHeader->Columns & column)
+         Out.*RowFields[bit] = Value(row, column) + f * (Value(row+1, column) - Value(row, column));
+   }
+   return 1;
+}
@@ -0,0 +1,121 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _TRAJECTORYFILE_
+#define _TRAJECTORYFILE_
+
+#include <stddef.h>
+#include <vector>
+
+#include "ballistics.h"
+#include "batchsolver.h"
+
+// A versioned binary file holding one solution table (see SolveTable and BatchSolver), laid out so it
+// can be memory mapped and read in place: a fixed header, then one array per stored column.
+//
+//    header:   TrajectoryFileHeader, with the inputs the table was solved for
+//    columns:  for each column in the header's Columns, in EPathColumn bit order, RowCount values in
+//              the header's Encoding, starting at ColumnOffset[bit], 8 byte aligned
+//
+// All values are little endian; a file from a big endian machine fails the magic number check.
+// Readers accept any file of their Version, and reject others.
+
+#define TRAJECTORYFILE_MAGIC 0x4A525442 // "BTRJ"
+#define TRAJECTORYFILE_VERSION 1
+#define TRAJECTORYFILE_BLOCK 64 // rows per base value, in TRAJECTORY_DELTA32 columns
+
+// How a column's values are stored.
+//    TRAJECTORY_FLOAT64:  as they are, 8 bytes a row.
+//    TRAJECTORY_FLOAT32:  rounded to float, 4 bytes a row.  About 7 significant digits.
+//    TRAJECTORY_DELTA32:  as float differences from a double base, one base per TRAJECTORYFILE_BLOCK
+//                         rows (the block's first value), so 4.125 bytes a row.  The error is a float's
+//                         rounding of the change within the block, not of the value itself, which keeps
+//                         slowly changing columns like Range and Time far more precise than FLOAT32.
+enum ETrajectoryEncoding { TRAJECTORY_FLOAT64, TRAJECTORY_FLOAT32, TRAJECTORY_DELTA32 };
+
+struct TrajectoryFileHeader
+{
+   unsigned Magic;
+   unsigned Version;
+   unsigned HeaderSize;          // sizeof(TrajectoryFileHeader) when written
+   int Encoding;                 // ETrajectoryEncoding
+   int Columns;                  // EPathColumn bits of the stored columns
+   int RowCount;
+
+   int DragFunction;             // EDragFunction
+   int Integrator;               // EIntegrator
+   double DragCoefficient;       // for standard conditions
+   double CorrectedDragCoefficient; // corrected for the atmosphere below
+   double MuzzleVelocity;        // in ft/s
+   double SightHeightOverBore;   // in inches
+
+   double Altitude_feet;
+   double Barometer_hg;
+   double Temperature_f;
+   double RelativeHumidity;
+
+   double ZeroRange_yard;
+   double yIntercept_inch;
+   double SightToBoreAngle;      // in degrees
+
+   double BoreAngle;             // in degrees
+   double WindSpeed_mile_hr;
+   double WindAngle;
+
+   double RangeStep_yard;        // the stride: row i is at i * RangeStep_yard yards
+   unsigned long long ColumnOffset[9]; // from the start of the file, by EPathColumn bit; 0 for columns not stored
+};
+
+// Writes the solution to a request as a trajectory file.  Returns 1 on success, or 0 if the file
+// could not be written.
+int WriteTrajectoryFile(const char* Path, const SolutionRequest& Request, const SolutionResult& Result, ETrajectoryEncoding Encoding);
+
+// The bytes WriteTrajectoryFile writes, built in memory.
+std::vector<unsigned char> EncodeTrajectoryFile(const SolutionRequest& Request, const SolutionResult& Result, ETrajectoryEncoding Encoding);
+
+// A trajectory file, opened read only and memory mapped.  Opening checks the header and that every
+// column lies within the file, and reads nothing else: values are decoded from the mapping as they
+// are asked for, so opening costs the same whatever the size of the table.  A TrajectoryFile can be
+// read from any number of threads.
+class TrajectoryFile
+{
+public:
+   TrajectoryFile();
+   ~TrajectoryFile();
+
+   // Opens and maps a file.  Returns 1 on success, or 0 if it cannot be opened or is not a trajectory
+   // file of this version.  Closes any file already open.
+   int Open(const char* Path);
+
+   // Reads a trajectory file already in memory, 8 byte aligned, which must stay there until Close.
+   // Returns as Open does.
+   int Open(const void* Data, size_t Size);
+
+   void Close();
+
+   const TrajectoryFileHeader& Header() const { return *pHeader; }
+   int RowCount() const { return pHeader->RowCount; }
+
+   // The value of a column at a row, 0 <= Row < RowCount, or 0 if the column is not stored.
+   double Value(int Row, EPathColumn Column) const;
+
+   // Fills in the stored columns of a row, and zeroes the rest.
+   void GetRow(int Row, ProjectilePath& Out) const;
+
+   // Fills in the stored columns at a range, interpolated linearly between the rows on either side,
+   // and zeroes the rest.  Returns 1, or 0 if the range is outside the table.
+   int Interpolate(double Range_yard, ProjectilePath& Out) const;
+
+private:
+   const unsigned char* Data;
+   size_t Size;
+   const TrajectoryFileHeader* pHeader;
+   bool Mapped;      // Data is our mapping, to unmap on Close
+   void* MapHandle;  // Windows only: the file mapping object
+
+   TrajectoryFile(const TrajectoryFile&) = delete;
+   TrajectoryFile& operator=(const TrajectoryFile&) = delete;
+};
+
+#endif
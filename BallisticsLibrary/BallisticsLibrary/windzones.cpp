@@ -0,0 +1,151 @@
+#include "windzones.h"
+#include "basicprojectile.h"
+
+// The trapezoidal loop of a zone, compiled per drag function: the steps of SolveAll, up to the zone's end.
+struct ZoneLoop
+{
+   typedef int Result;
+   Projectile& projectile;
+   double& dt;
+   double headwind_mile_hr;
+   double End_feet;
+
+   template <class Drag> int Run()
+   {
+      for (;;)
+      {
+         if( !TrapezoidalStep<Drag>( projectile, dt, headwind_mile_hr, 0 ) )
+            return 0;
+         projectile.t += dt;
+         if (projectile.x >= End_feet)
+            return 1;
+      }
+   }
+};
+
+ZonedSolution::ZonedSolution(const Projectile& projectile, double RangeStep_yard, double MaxRange_yard)
+   : Flight(projectile), Resumed(0)
+{
+   Flight.StreamPath(NULL, NULL, MaxRange_yard, RangeStep_yard);
+   Flight.RecordPath(MaxRange_yard, RangeStep_yard);
+   Flight.PathColumns = PATH_ALL;
+
+   FlightCheckpoint muzzle;
+   Flight.SaveCheckpoint(muzzle, 0);
+   Checkpoints.push_back(muzzle);
+}
+
+double ZonedSolution::ZoneEnd_feet(int Zone) const
+{
+   return (Zone < (int)Zones.size()-1) ? Zones[Zone].Range_yard*3 : HUGE_VAL;
+}
+
+// Flies a zone from its checkpoint, and checkpoints the next where it takes hold.  Returns 1 if the
+// flight went on into the next zone, 0 if it ended in this one.
+int ZonedSolution::FlyZone(int Zone)
+{
+   double dt;
+   Flight.Resume(Checkpoints[Zone], dt);
+   double end = ZoneEnd_feet(Zone);
+
+   int reached = 0;
+   if (Flight.Integrator == RK45)
+   {
+      // The RK45 step advances t itself.
+      while (Flight.Update(dt, Headwind[Zone], 0))
+      {
+         if (Flight.x >= end)
+         {
+            reached = 1;
+            break;
+         }
+      }
+   }
+   else
+   {
+      ZoneLoop loop = { Flight, dt, Headwind[Zone], end };
+      reached = DispatchDrag(Flight, loop);
+   }
+   if (!reached)
+      return 0;
+
+   FlightCheckpoint next;
+   Flight.SaveCheckpoint(next, dt);
+   Checkpoints.push_back(next);
+   return 1;
+}
+
+// The windage of the rows from FirstRow on, by the superposition of the lag rule over the zones.
+void ZonedSolution::ComputeWindage(int FirstRow)
+{
+   int zones = (int)Checkpoints.size();
+   std::vector<double> change(zones), speed(zones);
+   double last = 0;
+   for (int z = 0; z < zones; z++)
+   {
+      double crosswind = CrossWindVelocity(Zones[z].Speed_mile_hr, Zones[z].Angle);
+      change[z] = (crosswind - last) * 17.60; // Convert to inches per second, as WindageCorrection.
+      last = crosswind;
+
+      // From the muzzle, the lag is reckoned from the muzzle velocity, as WindageCorrection does.
+      const FlightCheckpoint& start = Checkpoints[z];
+      speed[z] = z ? sqrt(start.vx*start.vx + start.vy*start.vy) : Flight.MuzzleVelocity;
+   }
+
+   int zone = 0;
+   for (int r = FirstRow; r < Flight.ProjectilePathCount; r++)
+   {
+      while (zone+1 < zones && Checkpoints[zone+1].ProjectilePathCount <= r)
+         zone++;
+
+      ProjectilePath& row = Flight.aProjectilePath[r];
+      double x = row.Range*3;
+      double windage = 0;
+      for (int z = 0; z <= zone; z++)
+      {
+         const FlightCheckpoint& start = Checkpoints[z];
+         windage += change[z] * ((row.Time - start.t) - (x - start.x)/speed[z]);
+      }
+      row.Windage = windage;
+      row.WindageMOA = RadtoMOA(atan(windage/(12*x)));
+   }
+}
+
+int ZonedSolution::Solve(const WindZone* NewZones, int ZoneCount)
+{
+   if (ZoneCount < 1)
+      return 0;
+
+   // The leading zones that fly as before: the same headwind, over the same ranges.  Of those, the
+   // leading ones with the same crosswind too keep their windage.
+   int old = (int)Zones.size();
+   int flown = 0;
+   while (flown < old && flown < ZoneCount
+          && HeadWindVelocity(NewZones[flown].Speed_mile_hr, NewZones[flown].Angle) == Headwind[flown]
+          && (flown == old-1) == (flown == ZoneCount-1)
+          && (flown == old-1 || NewZones[flown].Range_yard == Zones[flown].Range_yard))
+      flown++;
+   int kept = 0;
+   while (kept < flown
+          && CrossWindVelocity(NewZones[kept].Speed_mile_hr, NewZones[kept].Angle) == CrossWindVelocity(Zones[kept].Speed_mile_hr, Zones[kept].Angle))
+      kept++;
+
+   Zones.assign(NewZones, NewZones + ZoneCount);
+   Headwind.resize(ZoneCount);
+   for (int z = 0; z < ZoneCount; z++)
+      Headwind[z] = HeadWindVelocity(Zones[z].Speed_mile_hr, Zones[z].Angle);
+
+   // Resume from the first changed zone, unless the flight ended before it took hold.
+   Resumed = ZoneCount;
+   if (flown < (int)Checkpoints.size())
+   {
+      Resumed = flown;
+      Checkpoints.resize(flown+1);
+      for (int z = flown; z < ZoneCount && FlyZone(z); z++)
+         ;
+   }
+
+   if (kept < (int)Checkpoints.size())
+      ComputeWindage(Checkpoints[kept].ProjectilePathCount);
+   return Flight.ProjectilePathCount;
+}
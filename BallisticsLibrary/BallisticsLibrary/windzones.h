@@ -0,0 +1,65 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+#ifndef _WINDZONES_
+#define _WINDZONES_
+
+#include <vector>
+
+#include "ballistics.h"
+
+// One zone of a wind profile: the wind from the end of the zone before it, out to Range_yard.
+struct WindZone
+{
+   double Range_yard;    // where the zone ends, in yards.  The last zone goes on to the end of the flight.
+   double Speed_mile_hr;
+   double Angle;         // in degrees, as for SolveAll
+};
+
+// A flight through a profile of wind zones, solved again as the zones change.
+//
+// Each zone's headwind drives the flight from the first step that starts at or past the end of the zone
+// before it, so a zone's wind takes hold within a step of its start: half a foot with the Trapezoidal
+// integrator, and a step of the error control (tens of feet, at most) with RK45.  The flight is
+// checkpointed (see Projectile::SaveCheckpoint) where each zone takes hold.  When the zones change,
+// Solve resumes from the checkpoint of the first zone whose headwind or extent changed, keeping the
+// rows before it, so changing the far zones only flies the tail.
+//
+// The crosswinds do not enter the flight, only its windage, which is computed after it by the lag rule
+// of WindageCorrection, extended to zones by superposition: a crosswind W that starts at a point
+// (x0, t0) of the flight, where the speed is v0, deflects it W * ((t - t0) - (x - x0) / v0) by range x,
+// and a zone is the wind that starts at its start less the same wind starting at its end.  With one
+// zone, this is WindageCorrection.  Changing only crosswinds flies nothing at all.
+class ZonedSolution
+{
+public:
+   // Sets up a flight of a copy of projectile, which must have been fired, with a row every
+   // RangeStep_yard yards out to MaxRange_yard, as for SolveTable.
+   ZonedSolution(const Projectile& projectile, double RangeStep_yard, double MaxRange_yard);
+
+   // Solves the flight through Zones, in order of range, resuming the last solution where it still holds.
+   // Returns the number of rows, as SolveAll does.  It takes at least one zone: with none, it returns 0
+   // and leaves the last solution as it was.
+   int Solve(const WindZone* Zones, int ZoneCount);
+
+   int RowCount() const { return Flight.ProjectilePathCount; }
+   const ProjectilePath* Rows() const { return Flight.aProjectilePath; }
+
+   // The zone the last Solve resumed the flight from: 0 for the whole flight, or ZoneCount if it flew
+   // nothing, its zones having changed only in crosswind, or past where the flight ended.
+   int ResumedZone() const { return Resumed; }
+
+private:
+   Projectile Flight;
+   std::vector<WindZone> Zones;
+   std::vector<double> Headwind;                 // of each zone, in mi/hr
+   std::vector<FlightCheckpoint> Checkpoints;    // where each zone the flight reached takes hold
+   int Resumed;
+
+   double ZoneEnd_feet(int Zone) const;
+   int FlyZone(int Zone);
+   void ComputeWindage(int FirstRow);
+};
+
+#endif
@@ -0,0 +1,517 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+// Performance suite.
+//
+//    benchmark [Google Benchmark flags]   runs the benchmarks, for example --benchmark_filter=SolveAll
+//
+// The checks that what is timed here is right are in Tests/checks.cpp, which ctest runs.
+
+#include <benchmark/benchmark.h>
+
+#include <stdio.h>
+#include <vector>
+
+#include "ballistics.h"
+#include "drag.h"
+#include "basicprojectile.h"
+#include "retardationtable.h"
+#include "projectilebatch.h"
+#include "batchsolver.h"
+#include "dispersion.h"
+#include "trajectoryfile.h"
+#include "atmosphere.h"
+#include "rangecard.h"
+#include "inverseindex.h"
+#include "solutioncache.h"
+#include "windzones.h"
+
+#include "fixtures.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmarks
+
+// One drag evaluation in the middle of a velocity band.
+static void BM_DragRetardationVelocity(benchmark::State& state, EDragFunction DragFunction, double Velocity)
+{
+   double dc = 0.465;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(Velocity);
+      benchmark::DoNotOptimize(DragRetardationVelocity(DragFunction, dc, Velocity));
+   }
+}
+
+// The vectorized drag function over a spread of velocities, against the scalar one on the same input.
+static void BM_DragRetardationVelocityN(benchmark::State& state)
+{
+   const int count = 1024;
+   std::vector<double> dc(count, 0.465), v(count), r(count);
+   for (int i = 0; i < count; i++)
+      v[i] = 500 + 3000.0 * i / count;
+
+   for (auto _ : state)
+   {
+      if (state.range(0))
+         DragRetardationVelocityN(G1, dc.data(), v.data(), r.data(), count);
+      else
+         for (int i = 0; i < count; i++)
+            r[i] = DragRetardationVelocity(G1, dc[i], v[i]);
+      benchmark::DoNotOptimize(r.data());
+      benchmark::ClobberMemory();
+   }
+   state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DragRetardationVelocityN)->ArgName("vectorized")->Arg(0)->Arg(1);
+
+// BM_DragRetardationVelocityN/vectorized:1, in float.
+static void BM_DragRetardationVelocityNFloat(benchmark::State& state)
+{
+   const int count = 1024;
+   std::vector<float> dc(count, 0.465f), v(count), r(count);
+   for (int i = 0; i < count; i++)
+      v[i] = 500 + 3000.0f * i / count;
+
+   for (auto _ : state)
+   {
+      DragRetardationVelocityN(G1, dc.data(), v.data(), r.data(), count);
+      benchmark::DoNotOptimize(r.data());
+      benchmark::ClobberMemory();
+   }
+   state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DragRetardationVelocityNFloat);
+
+static void BM_RetardationTableLookup(benchmark::State& state)
+{
+   RetardationTable table(G1, 0.465);
+   double v = 2650;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(v);
+      benchmark::DoNotOptimize(table.Lookup(v));
+   }
+}
+BENCHMARK(BM_RetardationTableLookup);
+
+// The compiled-in G1, against BM_DragRetardationVelocity/G1/2460-2680.
+static void BM_StandardDrag(benchmark::State& state)
+{
+   double v = 2570;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(v);
+      benchmark::DoNotOptimize(StandardDrag<G1>::DragRetardationVelocity(0.465, v));
+   }
+}
+BENCHMARK(BM_StandardDrag);
+
+// 1024 rounds stepped 200 times, in each precision.
+template <class Batch>
+static void BM_ProjectileBatch(benchmark::State& state)
+{
+   std::vector<PrecisionRound> rounds = MakePrecisionRounds(G1, 64);
+   for (auto _ : state)
+   {
+      Batch batch(G1, 1024);
+      for (int i = 0; i < 1024; i++)
+         batch.Add(rounds[i % 64].DragCoefficient, rounds[i % 64].MuzzleVelocity, 1.6, 0, rounds[i % 64].SightToBoreAngle);
+      for (int n = 0; n < 200; n++)
+         batch.Update(0);
+      benchmark::DoNotOptimize(batch.x[0]);
+   }
+   state.SetItemsProcessed(state.iterations() * 1024 * 200);
+}
+BENCHMARK_TEMPLATE(BM_ProjectileBatch, ProjectileBatch)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ProjectileBatch, MixedProjectileBatch)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ProjectileBatch, SingleProjectileBatch)->Unit(benchmark::kMicrosecond);
+
+// Corrections per second: 0 with pow, 1 with Horner's rule.
+static void BM_AtmosphericCorrection(benchmark::State& state)
+{
+   std::vector<Atmosphere> weather = MakeWeather(4096);
+   std::vector<double> corrected(weather.size());
+   for (auto _ : state)
+   {
+      if (state.range(0) == 0)
+      {
+         for (size_t i = 0; i < weather.size(); i++)
+            corrected[i] = 0.3 * ReferenceAtmosphericCorrection(weather[i]);
+      }
+      else
+         CorrectDragCoefficients(0.3, weather.data(), corrected.data(), (int)weather.size());
+      benchmark::DoNotOptimize(corrected.data());
+   }
+   state.SetItemsProcessed(state.iterations() * weather.size());
+}
+BENCHMARK(BM_AtmosphericCorrection)->ArgName("horner")->Arg(0)->Arg(1);
+
+// Integration steps per second, and the distance each step covers.
+static void BM_Update(benchmark::State& state)
+{
+   Projectile projectile = MakeProjectile((EIntegrator)state.range(0));
+   double angle = projectile.CalculateSightToBoreAngle(200, 0);
+   projectile.PathMaxRange = 1000;
+   projectile.PathRows = 1001;
+
+   projectile.Fire(0, angle);
+   double dt = 0;
+   long long flights = 0;
+   for (auto _ : state)
+   {
+      if (!projectile.Update(dt, 0, 0))
+      {
+         projectile.Fire(0, angle);
+         dt = 0;
+         flights++;
+      }
+      else if (projectile.Integrator == Trapezoidal)
+         projectile.t += dt;
+   }
+   state.SetItemsProcessed(state.iterations());
+   if (flights)
+      state.counters["steps_per_1000yd"] = (double)state.iterations() / flights;
+}
+BENCHMARK(BM_Update)->ArgName("rk45")->Arg(Trapezoidal)->Arg(RK45);
+
+// BM_Update/rk45:0, with the drag function compiled in.
+static void BM_BasicProjectileUpdate(benchmark::State& state)
+{
+   BasicProjectile<G1> projectile(0.465, 2650, 1.6);
+   double angle = projectile.CalculateSightToBoreAngle(200, 0);
+   projectile.PathMaxRange = 1000;
+   projectile.PathRows = 1001;
+
+   projectile.Fire(0, angle);
+   double dt = 0;
+   for (auto _ : state)
+   {
+      if (!projectile.Update(dt, 0, 0))
+      {
+         projectile.Fire(0, angle);
+         dt = 0;
+      }
+      else
+         projectile.t += dt;
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BasicProjectileUpdate);
+
+// A full flight, recording a row per yard.
+static void BM_SolveAll(benchmark::State& state)
+{
+   Projectile projectile = MakeProjectile((EIntegrator)state.range(1));
+   double angle = projectile.CalculateSightToBoreAngle(200, 0);
+   projectile.RecordPath((double)state.range(0), 1);
+
+   int rows = 0;
+   for (auto _ : state)
+   {
+      projectile.Fire(0, angle);
+      rows = SolveAll(10, 90, projectile);
+      benchmark::DoNotOptimize(projectile.aProjectilePath);
+   }
+   state.counters["rows"] = rows;
+}
+BENCHMARK(BM_SolveAll)->ArgNames({ "yd", "rk45" })->ArgsProduct({ { 1000, 2000 }, { Trapezoidal, RK45 } })->Unit(benchmark::kMicrosecond);
+
+// A rangefinder query: three ranges, against BM_SolveAll's row per yard.
+static void BM_SolveRanges(benchmark::State& state)
+{
+   Projectile projectile = MakeProjectile((EIntegrator)state.range(0));
+   double angle = projectile.CalculateSightToBoreAngle(200, 0);
+   const double ranges[3] = { 637, 412.5, 980 };
+   ProjectilePath rows[3];
+
+   for (auto _ : state)
+   {
+      projectile.Fire(0, angle);
+      benchmark::DoNotOptimize(SolveRanges(10, 90, projectile, ranges, 3, rows));
+   }
+}
+BENCHMARK(BM_SolveRanges)->ArgName("rk45")->Arg(Trapezoidal)->Arg(RK45)->Unit(benchmark::kMicrosecond);
+
+// A 1000 yd card at 25 yd steps, by SolveRangeCard (card:1) or one SolveTable per wind (card:0).
+static void BM_RangeCard(benchmark::State& state)
+{
+   Projectile projectile = MakeProjectile((EIntegrator)state.range(2));
+   double angle = projectile.CalculateSightToBoreAngle(100, 0);
+   projectile.Fire(0, angle);
+   std::vector<RangeCardWind> winds = MakeCardWinds(state.range(1) != 0);
+   RangeCard card;
+   std::vector<double> table(PathTableRows(1000, 25) * PathColumnCount(PATH_ALL));
+
+   for (auto _ : state)
+   {
+      if (state.range(0))
+         SolveRangeCard(projectile, 25, 1000, winds.data(), (int)winds.size(), card);
+      else
+      {
+         for (size_t w = 0; w < winds.size(); w++)
+         {
+            Projectile flight = projectile;
+            SolveTable(winds[w].Speed_mile_hr, winds[w].Angle, flight, 25, 1000, PATH_ALL, table.data());
+         }
+      }
+   }
+   state.counters["winds"] = (double)winds.size();
+}
+BENCHMARK(BM_RangeCard)->ArgNames({ "card", "quartering", "rk45" })->ArgsProduct({ { 0, 1 }, { 0, 1 }, { Trapezoidal, RK45 } })->Unit(benchmark::kMicrosecond);
+
+// Updates to a four zone wind call out to 1000 yards, changing the last zone (tail:1) or the first (tail:0),
+// so the flight resumes at 750 yards, or flies again from the muzzle.
+static void BM_WindZones(benchmark::State& state)
+{
+   Projectile projectile = MakeProjectile((EIntegrator)state.range(1));
+   double angle = projectile.CalculateSightToBoreAngle(100, 0);
+   projectile.Fire(0, angle);
+   ZonedSolution solution(projectile, 1, 1000);
+   std::vector<WindZone> zones = MakeWindZones(10, 30);
+   solution.Solve(zones.data(), (int)zones.size());
+
+   int n = 0;
+   int changed = state.range(0) ? 3 : 0;
+   for (auto _ : state)
+   {
+      zones[changed].Speed_mile_hr = (n++ & 1) ? 15 : 10;
+      benchmark::DoNotOptimize(solution.Solve(zones.data(), (int)zones.size()));
+   }
+   state.counters["resumed"] = solution.ResumedZone();
+}
+BENCHMARK(BM_WindZones)->ArgNames({ "tail", "rk45" })->ArgsProduct({ { 0, 1 }, { Trapezoidal, RK45 } })->Unit(benchmark::kMicrosecond);
+
+// Inverse queries of a 1000 yard table with a row every yard: the far range for a correction, the path
+// and the time of flight, and the maximum point blank range.
+static void BM_InverseIndexQuery(benchmark::State& state)
+{
+   InverseIndex index;
+   MakeInverseTable(RK45, 200, 1, index);
+   const EPathColumn columns[3] = { PATH_MOA, PATH_PATH, PATH_TIME };
+   const double values[3] = { 10, -100, 1 };
+   double step[3] = { 0.37, -3.1, 0.011 };
+
+   double value = values[state.range(0) % 3];
+   double ranges[2];
+   PointBlank blank;
+   for (auto _ : state)
+   {
+      if (state.range(0) == 3)
+         benchmark::DoNotOptimize(index.PointBlankRange(10, blank));
+      else
+      {
+         benchmark::DoNotOptimize(index.RangesAt(columns[state.range(0)], value, ranges, 2));
+         value += step[state.range(0)];
+         if (fabs(value - values[state.range(0)]) > 30*fabs(step[state.range(0)]))
+            value = values[state.range(0)];
+      }
+   }
+}
+BENCHMARK(BM_InverseIndexQuery)->ArgName("moa_path_time_pbr")->DenseRange(0, 3);
+
+// The same MOA queries as BM_InverseIndexQuery, by scanning the table's rows for the far crossing.
+static void BM_InverseScan(benchmark::State& state)
+{
+   InverseIndex index;
+   std::vector<double> table = MakeInverseTable(RK45, 200, 1, index);
+   int columns = PathColumnCount(PATH_ALL);
+   int rows = index.RowCount();
+
+   double value = 10;
+   for (auto _ : state)
+   {
+      double range = 0;
+      for (int r = rows - 1; r > 0; r--)
+      {
+         double a = table[(r-1)*columns + 2], b = table[r*columns + 2];
+         if ((a < value) != (b < value))
+         {
+            range = table[(r-1)*columns] + (value - a) / (b - a) * (table[r*columns] - table[(r-1)*columns]);
+            break;
+         }
+      }
+      benchmark::DoNotOptimize(range);
+      value = (value < 20) ? value + 0.37 : 10;
+   }
+}
+BENCHMARK(BM_InverseScan);
+
+static void BM_InverseIndexBuild(benchmark::State& state)
+{
+   InverseIndex index;
+   std::vector<double> table = MakeInverseTable(RK45, 200, 1, index);
+   for (auto _ : state)
+      benchmark::DoNotOptimize(index.Build(table.data(), index.RowCount(), PATH_ALL));
+}
+BENCHMARK(BM_InverseIndexBuild)->Unit(benchmark::kMicrosecond);
+
+// A real-time loop: one Advance per 60 Hz frame, refiring at the ground.
+static void BM_Advance(benchmark::State& state)
+{
+   Projectile projectile = MakeProjectile((EIntegrator)state.range(0));
+   double angle = projectile.CalculateSightToBoreAngle(200, 0);
+   projectile.SightHeightOverGround = 5;
+
+   projectile.Fire(0, angle);
+   long long flights = 0;
+   for (auto _ : state)
+   {
+      if (!projectile.Advance(1.0/60, 0, 0))
+      {
+         projectile.Fire(0, angle);
+         flights++;
+      }
+   }
+   state.SetItemsProcessed(state.iterations());
+   if (flights)
+      state.counters["frames_per_flight"] = (double)state.iterations() / flights;
+}
+BENCHMARK(BM_Advance)->ArgName("rk45")->Arg(Trapezoidal)->Arg(RK45);
+
+// The zero search, from scratch.
+static void BM_CalculateSightToBoreAngle(benchmark::State& state)
+{
+   Projectile projectile = MakeProjectile((EIntegrator)state.range(1));
+   double range = (double)state.range(0);
+   for (auto _ : state)
+      benchmark::DoNotOptimize(projectile.CalculateSightToBoreAngle(range, 0));
+}
+BENCHMARK(BM_CalculateSightToBoreAngle)->ArgNames({ "yd", "rk45" })->ArgsProduct({ { 100, 200, 300, 600, 1000 }, { Trapezoidal, RK45 } })->Unit(benchmark::kMicrosecond);
+
+// The zero search, warm started from the zero before a 2% change in the drag coefficient.
+static void BM_CalculateSightToBoreAngleWarm(benchmark::State& state)
+{
+   Projectile projectile = MakeProjectile((EIntegrator)state.range(1));
+   double range = (double)state.range(0);
+   double previous = projectile.CalculateSightToBoreAngle(range, 0);
+   projectile.DragCoefficient *= 1.02;
+   for (auto _ : state)
+      benchmark::DoNotOptimize(projectile.CalculateSightToBoreAngle(range, 0, previous));
+}
+BENCHMARK(BM_CalculateSightToBoreAngleWarm)->ArgNames({ "yd", "rk45" })->ArgsProduct({ { 100, 200, 300, 600, 1000 }, { Trapezoidal, RK45 } })->Unit(benchmark::kMicrosecond);
+
+static void BM_BatchSolver(benchmark::State& state)
+{
+   BatchSolver solver((int)state.range(0));
+   std::vector<SolutionRequest> requests = MakeRequests(256, (EIntegrator)state.range(1));
+   std::vector<SolutionResult> results;
+   for (auto _ : state)
+      solver.Solve(requests, results);
+   state.SetItemsProcessed(state.iterations() * requests.size());
+}
+BENCHMARK(BM_BatchSolver)->ArgNames({ "threads", "rk45" })->ArgsProduct({ { 1, 0 }, { Trapezoidal, RK45 } })->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Samples per second of a dispersion study.
+static void BM_Dispersion(benchmark::State& state)
+{
+   DispersionSolver solver((int)state.range(0));
+   DispersionRequest request = MakeDispersionRequest(4096, (EIntegrator)state.range(1));
+   DispersionResult result;
+   for (auto _ : state)
+      solver.Solve(request, result);
+   state.SetItemsProcessed(state.iterations() * request.Count);
+   state.counters["hit_percent"] = result.HitProbability*100;
+}
+BENCHMARK(BM_Dispersion)->ArgNames({ "threads", "rk45" })->ArgsProduct({ { 1, 0 }, { Trapezoidal, RK45 } })->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static const char* const TrajectoryFileName = "benchmark_trajectory.btrj";
+
+// A cold start: map a table, read one range from it, and unmap it.
+static void BM_TrajectoryFileOpen(benchmark::State& state)
+{
+   SolutionResult result;
+   SolutionRequest request = MakeTrajectoryRequest(result);
+   WriteTrajectoryFile(TrajectoryFileName, request, result, (ETrajectoryEncoding)state.range(0));
+
+   ProjectilePath row;
+   for (auto _ : state)
+   {
+      TrajectoryFile file;
+      file.Open(TrajectoryFileName);
+      file.Interpolate(637.5, row);
+      benchmark::DoNotOptimize(row);
+   }
+   remove(TrajectoryFileName);
+}
+BENCHMARK(BM_TrajectoryFileOpen)->ArgName("encoding")->Arg(TRAJECTORY_FLOAT64)->Arg(TRAJECTORY_FLOAT32)->Arg(TRAJECTORY_DELTA32);
+
+static void BM_TrajectoryFileInterpolate(benchmark::State& state)
+{
+   SolutionResult result;
+   SolutionRequest request = MakeTrajectoryRequest(result);
+   std::vector<unsigned char> data = EncodeTrajectoryFile(request, result, (ETrajectoryEncoding)state.range(0));
+   TrajectoryFile file;
+   file.Open(data.data(), data.size());
+
+   ProjectilePath row;
+   double range = 0;
+   for (auto _ : state)
+   {
+      file.Interpolate(range, row);
+      benchmark::DoNotOptimize(row);
+      range = (range < 990) ? range + 7.3 : 0;
+   }
+   state.counters["bytes_per_row"] = (double)data.size() / result.RowCount;
+}
+BENCHMARK(BM_TrajectoryFileInterpolate)->ArgName("encoding")->Arg(TRAJECTORY_FLOAT64)->Arg(TRAJECTORY_FLOAT32)->Arg(TRAJECTORY_DELTA32);
+
+// A repeated dope card request, answered from the cache.
+static void BM_SolutionCacheHit(benchmark::State& state)
+{
+   SolutionCache cache(1024);
+   std::vector<SolutionRequest> requests = MakeRequests(64, Trapezoidal);
+   for (size_t i = 0; i < requests.size(); i++)
+      cache.Solve(requests[i]);
+
+   size_t i = 0;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(cache.Solve(requests[i]));
+      i = (i+1) % requests.size();
+   }
+}
+BENCHMARK(BM_SolutionCacheHit);
+
+// A new wind for a cached zero: the table is solved, the zero search is not.
+static void BM_SolutionCacheZeroHit(benchmark::State& state)
+{
+   SolutionCache cache(1);
+   SolutionRequest request = MakeRequests(1, Trapezoidal)[0];
+   cache.Solve(request);
+
+   for (auto _ : state)
+   {
+      request.WindAngle = request.WindAngle == 90 ? 270 : 90;
+      benchmark::DoNotOptimize(cache.Solve(request));
+   }
+}
+BENCHMARK(BM_SolutionCacheZeroHit)->Unit(benchmark::kMicrosecond);
+
+// One benchmark per velocity band of every built-in drag function, named by the band's velocities.
+static void RegisterDragBenchmarks()
+{
+   for (int f = 0; f < 6; f++)
+   {
+      const DragModel* model = GetDragModel(DragFunctions[f]);
+      for (int i = 0; i < model->BandCount; i++)
+      {
+         double low = model->Bands[i].Velocity;
+         double high = i ? model->Bands[i-1].Velocity : DRAG_MAXVELOCITY;
+         char name[64];
+         sprintf(name, "BM_DragRetardationVelocity/%s/%.0f-%.0f", DragFunctionNames[DragFunctions[f]], low, high);
+         benchmark::RegisterBenchmark(name, BM_DragRetardationVelocity, DragFunctions[f], (low+high)/2)->MinTime(0.02);
+      }
+   }
+}
+
+int main(int argc, char** argv)
+{
+   RegisterDragBenchmarks();
+   benchmark::Initialize(&argc, argv);
+   if (benchmark::ReportUnrecognizedArguments(argc, argv))
+      return 1;
+   benchmark::RunSpecifiedBenchmarks();
+   benchmark::Shutdown();
+   return 0;
+}
@@ -0,0 +1,54 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+// Solves the trapezoidal cases of golden.h with the baseline solver, the Projectile::Update and SolveAll
+// the library started from (commit d13d086), so that the golden check holds the trapezoidal integrator
+// to its original results rather than to whatever it computes today.
+//
+// It is built against the baseline's ballistics.h and ballistics.cpp, not against the library, and takes
+// each case's zero from golden.h.  It prints the rows of each trapezoidal case, in the order of golden.h,
+// one row per line, for "checks --golden".  From BallisticsLibrary, with the library built in build:
+//
+//    build/checks --golden > Tests/golden.h      (only if the cases or their zeros change)
+//    mkdir baseline
+//    git show d13d086:BallisticsLibrary/BallisticsLibrary/ballistics.h | grep -v conio.h > baseline/ballistics.h
+//    git show d13d086:BallisticsLibrary/BallisticsLibrary/ballistics.cpp | sed "s/^int main()/int demo()/; s/getch();//" > baseline/ballistics.cpp
+//    c++ -O2 -Ibaseline -ITests Tests/baselinegolden.cpp baseline/ballistics.cpp -o baseline/baselinegolden
+//    baseline/baselinegolden > baseline/trapezoidal.txt
+//    build/checks --golden baseline/trapezoidal.txt > Tests/golden.h
+
+#include "ballistics.h"
+
+// The baseline only has the trapezoidal integrator.
+enum EIntegrator { Trapezoidal, RK45 };
+
+#include "golden.h"
+
+int main()
+{
+   for (int k = 0; k < GOLDEN_CASES; k++)
+   {
+      const GoldenCase& c = GoldenCases[k];
+      if (c.Integrator != Trapezoidal)
+         continue;
+
+      Projectile projectile(c.DragCoefficient, c.DragFunction, c.MuzzleVelocity, c.SightHeightOverBore);
+      projectile.DragCoefficientAtmosphericCorrection(c.Altitude_feet, 29.92, c.Temperature_f, 0.5);
+      projectile.Fire(0, c.SightToBoreAngle);
+      int rows = SolveAll(c.WindSpeed_mile_hr, c.WindAngle, projectile);
+
+      // The baseline keeps a row every yard; golden.h has one every GOLDEN_STEP yards, from GOLDEN_STEP on.
+      for (int i = 1; i <= GOLDEN_ROWS; i++)
+      {
+         if (i*GOLDEN_STEP < rows)
+         {
+            const ProjectilePath& row = projectile.aProjectilePath[i*GOLDEN_STEP];
+            printf("%.17g %.17g %.17g %.17g\n", row.Path, row.Time, row.Windage, row.Velocity);
+         }
+         else
+            printf("0 0 0 0\n");
+      }
+   }
+   return 0;
+}
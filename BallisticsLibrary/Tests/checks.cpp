@@ -0,0 +1,1238 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+// Accuracy regression and consistency checks, run by ctest as "accuracy".
+//
+//    checks            compares the solver against the golden trajectories in golden.h and runs the
+//                      consistency checks; exits with 1 on any failure
+//    checks --golden [trapezoidal.txt]
+//                      prints a new golden.h: the zeros and the RK45 rows from the current solver, and
+//                      the trapezoidal rows from trapezoidal.txt, as printed by baselinegolden.cpp with the
+//                      baseline solver (without it, from the current solver too)
+//
+// Regenerate golden.h only for a change that is meant to move the trajectories, and say so in its commit.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ballistics.h"
+#include "drag.h"
+#include "basicprojectile.h"
+#include "retardationtable.h"
+#include "integrator.h"
+#include "projectilebatch.h"
+#include "batchsolver.h"
+#include "dispersion.h"
+#include "trajectoryfile.h"
+#include "atmosphere.h"
+#include "rangecard.h"
+#include "inverseindex.h"
+#include "solutioncache.h"
+#include "windzones.h"
+#include "instrument.h"
+
+#include "fixtures.h"
+#include "golden.h"
+
+static const char* const TrajectoryFileName = "checks_trajectory.btrj";
+static const char* const EncodingNames[] = { "float64", "float32", "delta32" };
+static const char* const PathColumnNames[] = { "range", "path", "MOA", "time", "windage", "windage MOA", "velocity", "vx", "vy" };
+
+// Solves a golden case: its zero, then its rows from GOLDEN_STEP to GOLDEN_ROWS*GOLDEN_STEP yards.
+// Row 0 is left out: at 0 yards the MOA columns divide by zero.
+static double SolveGolden(const GoldenCase& Case, double Tolerance, double Rows[GOLDEN_ROWS][GOLDEN_COLUMNS])
+{
+   Projectile projectile(Case.DragCoefficient, Case.DragFunction, Case.MuzzleVelocity, Case.SightHeightOverBore);
+   projectile.Integrator = Case.Integrator;
+   projectile.Tolerance = Tolerance;
+   projectile.DragCoefficientAtmosphericCorrection(Case.Altitude_feet, 29.92, Case.Temperature_f, 0.5);
+
+   double angle = projectile.CalculateSightToBoreAngle(Case.ZeroRange_yard, 0);
+   projectile.Fire(0, angle);
+
+   int columns = PATH_PATH | PATH_TIME | PATH_WINDAGE | PATH_VELOCITY;
+   double table[(GOLDEN_ROWS+1)*GOLDEN_COLUMNS];
+   int rows = SolveTable(Case.WindSpeed_mile_hr, Case.WindAngle, projectile, GOLDEN_STEP, GOLDEN_ROWS*GOLDEN_STEP, columns, table);
+
+   for (int i = 0; i < GOLDEN_ROWS; i++)
+      for (int c = 0; c < GOLDEN_COLUMNS; c++)
+         Rows[i][c] = i+1 < rows ? table[(i+1)*GOLDEN_COLUMNS + c] : 0;
+   return angle;
+}
+
+static const char* GoldenColumnNames[GOLDEN_COLUMNS] = { "path", "time", "windage", "velocity" };
+
+// How far a value may move before the check fails: path and windage in inches, time in seconds,
+// velocity in ft/s, and the zero in MOA.  Far above rounding differences between compilers and
+// flags (the zero search itself stops within ZERO_TOLERANCE), far below any real change to the solver.
+static const double GoldenTolerance[GOLDEN_COLUMNS] = { 0.01, 1e-5, 0.01, 0.01 };
+static const double GoldenAngleTolerance_moa = 0.001;
+
+// How far each integrator may be from a converged reference solution (RK45 at a tolerance of 1e-10).
+static const double ReferencePathTolerance[2] = { 1, 0.001 }; // Trapezoidal, RK45; in inches
+
+static int Failures = 0;
+
+static void Check(bool Passed, const char* Name, const std::string& Detail)
+{
+   printf("%s  %s%s%s\n", Passed ? "ok  " : "FAIL", Name, Detail.empty() ? "" : "  ", Detail.c_str());
+   if (!Passed)
+      Failures++;
+}
+
+static std::string Format(const char* Format, ...)
+{
+   char text[256];
+   va_list args;
+   va_start(args, Format);
+   vsnprintf(text, sizeof(text), Format, args);
+   va_end(args);
+   return text;
+}
+
+static void CheckGolden()
+{
+   for (int k = 0; k < GOLDEN_CASES; k++)
+   {
+      const GoldenCase& golden = GoldenCases[k];
+      double rows[GOLDEN_ROWS][GOLDEN_COLUMNS];
+      double angle = SolveGolden(golden, RK45_TOLERANCE, rows);
+
+      double angleError = fabs(DegtoMOA(angle - golden.SightToBoreAngle));
+      double worst = 0;
+      int worstRow = 0, worstColumn = 0;
+      for (int i = 0; i < GOLDEN_ROWS; i++)
+         for (int c = 0; c < GOLDEN_COLUMNS; c++)
+         {
+            double error = fabs(rows[i][c] - golden.Rows[i][c]) / GoldenTolerance[c];
+            if (!(error <= worst))
+            {
+               worst = error;
+               worstRow = i;
+               worstColumn = c;
+            }
+         }
+
+      std::string name = Format("golden %s", golden.Name);
+      Check(angleError <= GoldenAngleTolerance_moa, name.c_str(), Format("zero off by %.2g MOA", angleError));
+      Check(worst <= 1, name.c_str(), Format("worst %s off by %.2g at %d yd", GoldenColumnNames[worstColumn],
+         worst * GoldenTolerance[worstColumn], (worstRow+1)*GOLDEN_STEP));
+
+      double reference[GOLDEN_ROWS][GOLDEN_COLUMNS];
+      GoldenCase tight = golden;
+      tight.Integrator = RK45;
+      SolveGolden(tight, 1e-10, reference);
+      double pathError = 0;
+      for (int i = 0; i < GOLDEN_ROWS; i++)
+         pathError = fmax(pathError, fabs(rows[i][0] - reference[i][0]));
+      Check(pathError <= ReferencePathTolerance[golden.Integrator], name.c_str(), Format("path within %.2g in of the converged solution", pathError));
+   }
+
+   // A zero range that is not positive has no zero to search for.
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      Projectile projectile = MakeProjectile((EIntegrator)integrator);
+      double angles[3] = { projectile.CalculateSightToBoreAngle(0, 0), projectile.CalculateSightToBoreAngle(-100, 1.5),
+                           projectile.CalculateSightToBoreAngle(0, 0, 0.1) };
+      Check(angles[0] == 0 && angles[1] == 0 && angles[2] == 0, Format("zero at no range %s", IntegratorNames[integrator]).c_str(),
+         Format("%g, %g and %g degrees", angles[0], angles[1], angles[2]));
+   }
+}
+
+// Counts the rows a StreamPath sink is given.
+static void CountPathRow(const ProjectilePath& Row, void* Context)
+{
+   (void)Row;
+   (*(int*)Context)++;
+}
+
+// SolveTable must leave the projectile recording as it found it: after RecordPath, SolveTable and
+// SolveAll, the rows must be those of RecordPath and SolveAll alone, and a StreamPath sink must still get its rows.
+static void CheckSolveTableRecording()
+{
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      Projectile projectile = MakeProjectile((EIntegrator)integrator);
+      double angle = projectile.CalculateSightToBoreAngle(100, 0);
+      projectile.RecordPath(1000, 1);
+      Projectile reference = projectile;
+      reference.Fire(0, angle);
+      int referenceRows = SolveAll(5, 90, reference);
+
+      std::vector<double> table(PathTableRows(500, 25) * PathColumnCount(PATH_PATH));
+      ProjectilePath* rows = projectile.aProjectilePath;
+      projectile.Fire(0, angle);
+      SolveTable(8, 270, projectile, 25, 500, PATH_PATH, table.data());
+      bool kept = projectile.aProjectilePath == rows && projectile.PathColumns == PATH_ALL && projectile.PathRows == reference.PathRows;
+      projectile.Fire(0, angle);
+      int recordedRows = SolveAll(5, 90, projectile);
+
+      int mismatches = 0;
+      for (int i = 0; i < referenceRows && i < recordedRows; i++)
+         if (memcmp(&projectile.aProjectilePath[i], &reference.aProjectilePath[i], sizeof(ProjectilePath)))
+            mismatches++;
+
+      int streamed = 0;
+      projectile.StreamPath(CountPathRow, &streamed, 1000, 1);
+      projectile.Fire(0, angle);
+      SolveTable(8, 270, projectile, 25, 500, PATH_PATH, table.data());
+      projectile.Fire(0, angle);
+      int streamedRows = SolveAll(5, 90, projectile);
+
+      Check(kept && recordedRows == referenceRows && mismatches == 0 && streamed == streamedRows,
+         Format("SolveTable recording %s", IntegratorNames[integrator]).c_str(),
+         Format("%d of %d rows, %d differ; %d of %d rows streamed", recordedRows, referenceRows, mismatches, streamed, streamedRows));
+   }
+}
+
+// SolveRanges must agree with a converged solution at ranges between the yards, and with
+// SolveTable's interpolated RK45 rows on the yards.
+static void CheckSolveRanges()
+{
+   const int count = 6;
+   const double ranges[count] = { 637.3, 0, 12.25, 1000, 399.9, 250 };
+   ProjectilePath reference[count], rows[count];
+
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      Projectile projectile(0.305, G7, 2710, 1.5);
+      projectile.Integrator = RK45;
+      projectile.Tolerance = 1e-10;
+      double angle = projectile.CalculateSightToBoreAngle(100, 0);
+      projectile.Fire(0, angle);
+      SolveRanges(8, 270, projectile, ranges, count, reference);
+
+      projectile.Integrator = (EIntegrator)integrator;
+      projectile.Tolerance = RK45_TOLERANCE;
+      projectile.Fire(0, angle);
+      int reached = SolveRanges(8, 270, projectile, ranges, count, rows);
+
+      double pathError = 0, timeError = 0;
+      for (int i = 0; i < count; i++)
+      {
+         pathError = fmax(pathError, fabs(rows[i].Path - reference[i].Path));
+         timeError = fmax(timeError, fabs(rows[i].Time - reference[i].Time));
+      }
+      Check(reached == count && pathError <= ReferencePathTolerance[integrator] && timeError <= 1e-4,
+         Format("SolveRanges %s", IntegratorNames[integrator]).c_str(),
+         Format("%d of %d reached, path within %.2g in and time within %.2g s of the converged solution", reached, count, pathError, timeError));
+   }
+
+   Projectile recorded(0.305, G7, 2710, 1.5);
+   recorded.Integrator = RK45;
+   double angle = recorded.CalculateSightToBoreAngle(100, 0);
+   recorded.RecordPath(1000, 1);
+   Projectile queried = recorded;
+   recorded.Fire(0, angle);
+   SolveAll(8, 270, recorded);
+
+   std::vector<double> yards;
+   for (int i = 1; i <= 1000; i += 37)
+      yards.push_back(i);
+   std::vector<ProjectilePath> interpolated(yards.size());
+   queried.Fire(0, angle);
+   SolveRanges(8, 270, queried, yards.data(), (int)yards.size(), interpolated.data());
+
+   double pathError = 0;
+   for (size_t i = 0; i < yards.size(); i++)
+      pathError = fmax(pathError, fabs(interpolated[i].Path - recorded.aProjectilePath[(int)yards[i]].Path));
+   Check(pathError <= 1e-6, "SolveRanges RK45 rows", Format("path within %.2g in of SolveAll's", pathError));
+}
+
+// StandardDrag must give the same bits as the registry, on and around every band edge.
+template <EDragFunction DragFunction>
+static void CheckStandardDrag()
+{
+   typedef StandardDragBands<DragFunction> Bands;
+   int mismatches = 0, count = 0;
+   for (int i = 0; i < Bands::Count; i++)
+      for (double v = Bands::Bands[i].Velocity - 1; v <= Bands::Bands[i].Velocity + 1; v += 0.125)
+      {
+         count++;
+         if (StandardDrag<DragFunction>::DragRetardationVelocity(0.465, v) != DragRetardationVelocity(DragFunction, 0.465, v))
+            mismatches++;
+      }
+   for (double v = 0.37; v < DRAG_MAXVELOCITY; v += 1)
+   {
+      count++;
+      if (StandardDrag<DragFunction>::DragRetardationVelocity(0.465, v) != DragRetardationVelocity(DragFunction, 0.465, v))
+         mismatches++;
+   }
+
+   Check(mismatches == 0, Format("StandardDrag %s", DragFunctionNames[DragFunction]).c_str(),
+      Format("%d of %d velocities differ from the registry", mismatches, count));
+}
+
+// RK45 Update starts each step from the derivative the last one ended with, unless the drag changed in
+// between: after a change of drag function, drag coefficient or RetardationTable, its step must be that
+// of a projectile that has no derivative to reuse.
+static void CheckUpdateRK45()
+{
+   RetardationTable table(G1, 0.465); // MakeProjectile's
+   int stale = 0;
+   for (int change = 0; change < 3; change++)
+   {
+      Projectile projectile = MakeProjectile(RK45);
+      projectile.Fire(0, 0.1);
+      double dt = 0;
+      for (int i = 0; i < 10; i++)
+         projectile.Update(dt, 5, 3);
+
+      if (change == 0)
+         projectile.DragFunction = G7;
+      if (change == 1)
+         projectile.DragCoefficient *= 1.1;
+      if (change == 2)
+         projectile.pRetardationTable = &table;
+
+      Projectile fresh = projectile;
+      fresh.UpdateDerivative.Valid = 0;
+      double freshdt = dt;
+      projectile.Update(dt, 5, 3);
+      fresh.Update(freshdt, 5, 3);
+      if (projectile.x != fresh.x || projectile.y != fresh.y || projectile.vx != fresh.vx || projectile.vy != fresh.vy || dt != freshdt)
+         stale++;
+   }
+   Check(stale == 0, "RK45 Update after a drag change", Format("%d of 3 changes step from a stale derivative", stale));
+}
+
+// BasicProjectile must step exactly like Projectile.
+static void CheckBasicProjectile()
+{
+   BasicProjectile<G7> basic(0.305, 2710, 1.5);
+   Projectile projectile(0.305, G7, 2710, 1.5);
+   double angle = projectile.CalculateSightToBoreAngle(100, 0);
+   basic.Fire(0, angle);
+   projectile.Fire(0, angle);
+
+   int steps = 0, mismatches = 0;
+   double dt = 0, basicdt = 0;
+   while (projectile.Update(dt, 5, 3) & basic.Update(basicdt, 5, 3))
+   {
+      projectile.t += dt;
+      basic.t += basicdt;
+      if (basic.x != projectile.x || basic.y != projectile.y || basic.vx != projectile.vx || basic.vy != projectile.vy)
+         mismatches++;
+      steps++;
+   }
+
+   Check(mismatches == 0, "BasicProjectile G7", Format("%d of %d steps differ from Projectile", mismatches, steps));
+}
+
+static char EventLetter(EProjectileEvent Event)
+{
+   switch (Event)
+   {
+   case EVENT_LINEOFSIGHT: return 'L';
+   case EVENT_TARGET: return 'T';
+   case EVENT_TRANSONIC: return 't';
+   case EVENT_SUBSONIC: return 's';
+   case EVENT_GROUND: return 'G';
+   default: return '?';
+   }
+}
+
+static void RecordEvent(const ProjectileEvent& Event, void* Context)
+{
+   ((std::vector<ProjectileEvent>*)Context)->push_back(Event);
+}
+
+static void CheckAdvance()
+{
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      Projectile projectile(0.305, G7, 2710, 1.5);
+      projectile.Integrator = RK45;
+      projectile.Tolerance = 1e-10;
+      double angle = projectile.CalculateSightToBoreAngle(100, 0);
+      const double target = 500;
+      ProjectilePath reference;
+      projectile.Fire(0, angle);
+      SolveRanges(8, 270, projectile, &target, 1, &reference);
+
+      // Sighted 200 ft over level ground, so it goes subsonic before it lands.
+      std::vector<ProjectileEvent> events;
+      projectile.Integrator = (EIntegrator)integrator;
+      projectile.Tolerance = RK45_TOLERANCE;
+      projectile.TargetRange = target;
+      projectile.SightHeightOverGround = 200;
+      projectile.EventHandler = RecordEvent;
+      projectile.EventContext = &events;
+      projectile.Fire(0, angle);
+
+      int frames = 0;
+      while (projectile.Advance(1.0/60, HeadWindVelocity(8, 270), CrossWindVelocity(8, 270)) && frames < 60*60)
+         frames++;
+      Projectile landed = projectile;
+      double height = -(landed.x*landed.Gx + landed.y*landed.Gy) / fabs(GRAVITY);
+      int moved = landed.Advance(1.0/60, 0, 0) || landed.x != projectile.x || landed.t != projectile.t;
+
+      std::string order;
+      bool ordered = true;
+      for (size_t i = 0; i < events.size(); i++)
+      {
+         order += EventLetter(events[i].Event);
+         ordered = ordered && (i == 0 || events[i].Time >= events[i-1].Time);
+      }
+      bool found = order == "LLTtsG";
+
+      Check(found && ordered && !moved && fabs(events[1].Range - 100) < 1 && fabs(height + 200) < 1e-9,
+         Format("Advance %s events", IntegratorNames[integrator]).c_str(),
+         Format("%s (line of sight twice, target, transonic, subsonic, ground), zero crossing at %.2f yd, landed %.2g ft from the ground, stopped %s",
+            order.c_str(), found ? events[1].Range : 0, fabs(height + 200), moved ? "no" : "yes"));
+      Check(found && fabs(events[2].Range - target) < 1e-6 && fabs(events[2].Path - reference.Path) <= ReferencePathTolerance[integrator]
+         && fabs(events[2].Time - reference.Time) <= 1e-4,
+         Format("Advance %s target", IntegratorNames[integrator]).c_str(),
+         Format("path within %.2g in and time within %.2g s of the converged solution",
+            found ? fabs(events[2].Path - reference.Path) : 0, found ? fabs(events[2].Time - reference.Time) : 0));
+   }
+}
+
+#ifdef BALLISTICS_INSTRUMENT
+static void CountZeroIteration(const BallisticsTrace& Trace, void* Context)
+{
+   if (Trace.Event == TRACE_ZEROITERATION)
+      (*(int*)Context)++;
+}
+
+static void CheckInstrument()
+{
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      int traced = 0;
+      SetBallisticsTrace(CountZeroIteration, &traced);
+      ResetBallisticsStats();
+
+      Projectile projectile = MakeProjectile((EIntegrator)integrator);
+      double angle = projectile.CalculateSightToBoreAngle(100, 0);
+      projectile.RecordPath(1000, 1);
+      projectile.Fire(0, angle);
+      SolveAll(0, 0, projectile);
+
+      SetBallisticsTrace(NULL, NULL);
+      BallisticsStats stats = GetBallisticsStats();
+      long long bandHits = 0;
+      for (int i = 0; i < DRAG_MAXBANDS; i++)
+         bandHits += stats.BandHits[i];
+
+      Check(stats.Solves == 1 && stats.Zeros == 1 && stats.ZeroIterations == traced && traced >= 2 && stats.Steps > 0
+         && bandHits == stats.DragEvaluations && stats.SolveSeconds > 0 && stats.ZeroSeconds > 0,
+         Format("Instrument %s", IntegratorNames[integrator]).c_str(),
+         Format("%lld steps, %lld rejected, %lld drag evaluations, %lld zero iterations (%d traced), %lld steep exits",
+            stats.Steps, stats.RejectedSteps, stats.DragEvaluations, stats.ZeroIterations, traced, stats.SteepExits));
+   }
+}
+#endif
+
+// DragRetardationVelocityN and RetardationTable against DragRetardationVelocity, within their documented errors.
+static void CheckDrag()
+{
+   for (int f = 0; f < 6; f++)
+   {
+      const int count = 9999;
+      std::vector<double> dc(count, 0.465), v(count), r(count);
+      for (int i = 0; i < count; i++)
+         v[i] = i + 0.37; // off the table's grid points
+      DragRetardationVelocityN(DragFunctions[f], dc.data(), v.data(), r.data(), count);
+      RetardationTable table(DragFunctions[f], 0.465);
+
+      std::vector<float> dcFloat(count, 0.465f), vFloat(v.begin(), v.end()), rFloat(count);
+      DragRetardationVelocityN(DragFunctions[f], dcFloat.data(), vFloat.data(), rFloat.data(), count);
+
+      double vectorError = 0, floatError = 0, tableError = 0;
+      for (int i = 0; i < count; i++)
+      {
+         double exact = DragRetardationVelocity(DragFunctions[f], 0.465, v[i]);
+         vectorError = fmax(vectorError, fabs(r[i] - exact) / exact);
+         double exactFloat = DragRetardationVelocity(DragFunctions[f], 0.465f, vFloat[i]);
+         floatError = fmax(floatError, fabs(rFloat[i] - exactFloat) / exactFloat);
+         if (v[i] >= 1000)
+            tableError = fmax(tableError, fabs(table.Lookup(v[i]) - exact) / exact);
+      }
+
+      // Below 1000 ft/s, sweep finely enough to land near the middle of every cell.
+      double slowError = 0, slowestError = 0;
+      for (double vSlow = 30.013; vSlow < 1000; vSlow += 0.0371)
+      {
+         double exact = DragRetardationVelocity(DragFunctions[f], 0.465, vSlow);
+         double error = fabs(table.Lookup(vSlow) - exact) / exact;
+         if (vSlow >= 100)
+            slowError = fmax(slowError, error);
+         else
+            slowestError = fmax(slowestError, error);
+      }
+
+      const char* name = DragFunctionNames[DragFunctions[f]];
+      Check(vectorError <= 1e-13, Format("DragRetardationVelocityN %s", name).c_str(), Format("relative error %.2g", vectorError));
+      Check(floatError <= 1e-5, Format("DragRetardationVelocityN float %s", name).c_str(), Format("relative error %.2g", floatError));
+      Check(tableError <= 2e-6, Format("RetardationTable %s", name).c_str(), Format("relative error %.2g from 1000 ft/s up", tableError));
+      Check(slowError <= 1e-5, Format("RetardationTable %s from 100 ft/s", name).c_str(), Format("relative error %.2g from 100 to 1000 ft/s", slowError));
+      Check(slowestError <= 1e-4, Format("RetardationTable %s from 30 ft/s", name).c_str(), Format("relative error %.2g from 30 to 100 ft/s", slowestError));
+   }
+
+   // RK45 with a RetardationTable takes the drag of every stage from the table, so it fits no steps to
+   // band edges, and flies within the table's error of RK45 without one.
+   Projectile exact = MakeProjectile(RK45);
+   double angle = exact.CalculateSightToBoreAngle(100, 0);
+   Projectile tabled = exact;
+   RetardationTable table(tabled.DragFunction, tabled.DragCoefficient);
+   tabled.pRetardationTable = &table;
+   DormandPrince integrator(tabled, 0, 0, 0);
+
+   const double ranges[4] = { 250, 500, 750, 1000 };
+   ProjectilePath exactRows[4], tabledRows[4];
+   exact.Fire(0, angle);
+   tabled.Fire(0, angle);
+   int reached = SolveRanges(0, 0, exact, ranges, 4, exactRows) + SolveRanges(0, 0, tabled, ranges, 4, tabledRows);
+   double pathError = 0;
+   for (int i = 0; i < 4; i++)
+      pathError = fmax(pathError, fabs(tabledRows[i].Path - exactRows[i].Path));
+   Check(integrator.Model == NULL && reached == 8 && pathError <= 0.01, "RetardationTable RK45",
+      Format("%s band edges; path within %.2g in of the drag function's", integrator.Model ? "fits steps to" : "no", pathError));
+}
+
+// The worst relative difference of a batch round's state from a projectile's.
+static double StateError(double x, double y, double vx, double vy, double t, const Projectile& p)
+{
+   const double got[5] = { x, y, vx, vy, t };
+   const double expected[5] = { p.x, p.y, p.vx, p.vy, p.t };
+   double error = 0;
+   for (int c = 0; c < 5; c++)
+      error = fmax(error, fabs(got[c] - expected[c]) / fmax(1, fabs(expected[c])));
+   return error;
+}
+
+// ProjectileBatch must step as Projectile::Update does, step for step, and end each round where and when
+// the projectile ends.  Its vectorized drag is within 1e-13 of the scalar one, so the two drift apart by
+// rounding alone: the state must stay within 1e-9, relative, over the whole flight.
+static void CheckBatchSteps()
+{
+   const int count = 16;
+   std::vector<PrecisionRound> rounds = MakePrecisionRounds(G7, count);
+   ProjectileBatch batch(G7, count);
+   std::vector<Projectile> projectiles;
+   std::vector<double> dt(count, 0);
+   std::vector<int> live(count, 1);
+   for (int i = 0; i < count; i++)
+   {
+      // Half shot level, half uphill, where they get too steep and end early.
+      double bore = (i % 2) ? 30 : 0;
+      Projectile projectile(rounds[i].DragCoefficient, G7, rounds[i].MuzzleVelocity, 1.6);
+      projectile.Fire(bore, rounds[i].SightToBoreAngle);
+      projectiles.push_back(projectile);
+      batch.Add(rounds[i].DragCoefficient, rounds[i].MuzzleVelocity, 1.6, bore, rounds[i].SightToBoreAngle);
+   }
+
+   long long steps = 0;
+   int mismatches = 0;
+   double error = 0;
+   while (batch.Count > 0)
+   {
+      batch.Update(0);
+      for (int i = 0; i < count; i++)
+      {
+         if (!live[i])
+            continue;
+         live[i] = projectiles[i].Update(dt[i], 0, 0);
+         if (live[i])
+            projectiles[i].t += dt[i];
+      }
+      steps++;
+
+      int alive = 0;
+      for (int i = 0; i < count; i++)
+         alive += live[i];
+      mismatches += alive != batch.Count;
+      for (int i = 0; i < batch.Count; i++)
+      {
+         const Projectile& p = projectiles[batch.Id[i]];
+         mismatches += !live[batch.Id[i]];
+         error = fmax(error, StateError(batch.x[i], batch.y[i], batch.vx[i], batch.vy[i], batch.t[i], p));
+      }
+   }
+
+   double finishError = 0;
+   for (size_t k = 0; k < batch.Finished.size(); k++)
+   {
+      const FinishedRound& round = batch.Finished[k];
+      finishError = fmax(finishError, StateError(round.x, round.y, round.vx, round.vy, round.t, projectiles[round.Id]));
+   }
+
+   Check(mismatches == 0 && error <= 1e-9 && (int)batch.Finished.size() == count && finishError <= 1e-9, "ProjectileBatch steps",
+      Format("%lld steps, %d mismatched, state within %.2g of Projectile::Update, %d of %d finished within %.2g",
+         steps, mismatches, error, (int)batch.Finished.size(), count, finishError));
+}
+
+// BatchSolver must give the same bits as solving the requests one at a time, at any thread count.
+static void CheckBatch()
+{
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      std::vector<SolutionRequest> requests = MakeRequests(64, (EIntegrator)integrator);
+
+      std::vector<SolutionResult> expected(requests.size());
+      Projectile scratch(1, G1, 1, 0);
+      for (size_t i = 0; i < requests.size(); i++)
+         BatchSolver::SolveOne(requests[i], scratch, expected[i]);
+
+      for (int threads = 1; threads <= 4; threads *= 2)
+      {
+         BatchSolver solver(threads);
+         std::vector<SolutionResult> results;
+         solver.Solve(requests, results);
+
+         int mismatches = 0;
+         for (size_t i = 0; i < requests.size(); i++)
+            if (results[i].RowCount != expected[i].RowCount || results[i].SightToBoreAngle != expected[i].SightToBoreAngle ||
+               memcmp(results[i].Table.data(), expected[i].Table.data(), results[i].Table.size() * sizeof(double)) != 0)
+               mismatches++;
+
+         Check(mismatches == 0, Format("BatchSolver %s, %d threads", IntegratorNames[integrator], threads).c_str(),
+            Format("%d of %d results differ from sequential", mismatches, (int)requests.size()));
+      }
+
+      // Several callers sharing one solver, each with the requests from its own offset on.
+      const int callers = 4;
+      BatchSolver shared(2);
+      std::vector<SolutionResult> results[callers];
+      std::vector<std::thread> threads;
+      for (int c = 0; c < callers; c++)
+         threads.push_back(std::thread([&, c]
+         {
+            std::vector<SolutionRequest> mine(requests.begin() + c, requests.end());
+            shared.Solve(mine, results[c]);
+         }));
+      for (size_t c = 0; c < threads.size(); c++)
+         threads[c].join();
+
+      int mismatches = 0, count = 0;
+      for (int c = 0; c < callers; c++)
+         for (size_t i = 0; i < results[c].size(); i++, count++)
+            if (results[c][i].RowCount != expected[c+i].RowCount || results[c][i].SightToBoreAngle != expected[c+i].SightToBoreAngle ||
+               memcmp(results[c][i].Table.data(), expected[c+i].Table.data(), results[c][i].Table.size() * sizeof(double)) != 0)
+               mismatches++;
+      Check(mismatches == 0 && count == callers*(int)requests.size() - callers*(callers-1)/2,
+         Format("BatchSolver %s, %d callers", IntegratorNames[integrator], callers).c_str(),
+         Format("%d of %d results differ from sequential", mismatches, count));
+   }
+}
+
+// The dispersion solver's generator must match Philox's known answers, its samples must not depend on
+// the thread count or on other callers, and with only aiming error its hit probability and spread must be the known ones.
+static void CheckDispersion()
+{
+   // Philox4x32-10 known answers, from the Random123 distribution.
+   const unsigned counters[3][4] = { { 0, 0, 0, 0 }, { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } };
+   const unsigned keys[3][2] = { { 0, 0 }, { 0xffffffff, 0xffffffff }, { 0xa4093822, 0x299f31d0 } };
+   const unsigned answers[3][4] = { { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 }, { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd }, { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } };
+   int wrong = 0;
+   for (int i = 0; i < 3; i++)
+   {
+      unsigned out[4];
+      Philox4x32(counters[i], keys[i], out);
+      wrong += memcmp(out, answers[i], sizeof(out)) != 0;
+   }
+   Check(wrong == 0, "Philox4x32-10", Format("%d of 3 known answers wrong", wrong));
+
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      // The same samples, whatever the thread count.
+      DispersionRequest request = MakeDispersionRequest(1000, (EIntegrator)integrator);
+      DispersionResult expected, result;
+      DispersionSolver(1).Solve(request, expected);
+      DispersionSolver(3).Solve(request, result);
+      Check(memcmp(&expected, &result, sizeof(result)) == 0 && expected.Reached == request.Count,
+         Format("Dispersion %s, 1 and 3 threads", IntegratorNames[integrator]).c_str(),
+         Format("%d hits of %d, %s", result.Hits, request.Count, memcmp(&expected, &result, sizeof(result)) ? "results differ" : "same results"));
+
+      // Two callers sharing one solver, each with its own request, get what they would alone.
+      DispersionRequest other = request;
+      other.Seed++;
+      other.WindSpeed_mile_hr.Mean += 5;
+      DispersionResult otherExpected, shared[2];
+      DispersionSolver(1).Solve(other, otherExpected);
+      DispersionSolver solver(2);
+      std::thread caller([&]
+      {
+         solver.Solve(other, shared[1]);
+      });
+      solver.Solve(request, shared[0]);
+      caller.join();
+      int differ = (memcmp(&shared[0], &expected, sizeof(expected)) != 0) + (memcmp(&shared[1], &otherExpected, sizeof(otherExpected)) != 0);
+      Check(differ == 0, Format("Dispersion %s, 2 callers", IntegratorNames[integrator]).c_str(),
+         Format("%d of 2 results differ from a single caller's", differ));
+   }
+
+   // With only aiming error, the impacts are normal with a known spread, and the hit probability is known.
+   DispersionRequest request = MakeDispersionRequest(20000, RK45);
+   request.DragCoefficient.Sigma = request.MuzzleVelocity.Sigma = request.WindSpeed_mile_hr.Sigma = 0;
+   request.WindAngle.Sigma = request.Range_yard.Sigma = 0;
+   request.TargetWidth_inch = request.TargetHeight_inch = 6;
+   DispersionResult result;
+   DispersionSolver().Solve(request, result);
+
+   double sigma = tan(MOAtoRad(request.Aim_moa)) * request.Range_yard.Mean*36;
+   double expected = pow(erf(request.TargetWidth_inch/2 / (sigma*sqrt(2.0))), 2);
+   double spread = sqrt(expected*(1-expected)/request.Count);
+   Check(fabs(result.HitProbability - expected) < 4*spread && fabs(result.MeanHorizontal) < 4*sigma/sqrt((double)request.Count)
+      && fabs(result.MeanVertical) < 4*sigma/sqrt((double)request.Count) && fabs(sqrt(result.Covariance[1][1])/sigma - 1) < 0.03
+      && fabs(result.Covariance[0][1]) < 0.03*sigma*sigma,
+      "Dispersion aiming error",
+      Format("%.4f hit, %.4f expected; sd %.3f and %.3f in, %.3f expected", result.HitProbability, expected,
+         sqrt(result.Covariance[0][0]), sqrt(result.Covariance[1][1]), sigma));
+}
+
+static void CheckTrajectoryFile()
+{
+   SolutionResult result;
+   SolutionRequest request = MakeTrajectoryRequest(result);
+   const double tolerance[3] = { 0, 1e-6, 1e-6 }; // relative to each column's largest value
+
+   for (int encoding = TRAJECTORY_FLOAT64; encoding <= TRAJECTORY_DELTA32; encoding++)
+   {
+      TrajectoryFile file;
+      int opened = WriteTrajectoryFile(TrajectoryFileName, request, result, (ETrajectoryEncoding)encoding) && file.Open(TrajectoryFileName);
+      const TrajectoryFileHeader& header = file.Header();
+      bool described = opened && header.RowCount == result.RowCount && header.Columns == request.Columns && header.DragFunction == request.DragFunction
+         && header.MuzzleVelocity == request.MuzzleVelocity && header.SightToBoreAngle == result.SightToBoreAngle && header.RangeStep_yard == request.RangeStep_yard;
+
+      // The worst error of each column, relative to the column's largest value.
+      double error = 0;
+      int worst = 0;
+      for (int column = 0; opened && column < 9; column++)
+      {
+         double largest = 0, columnError = 0;
+         for (int row = 0; row < result.RowCount; row++)
+         {
+            double value = result.Table[row*9 + column];
+            largest = fmax(largest, fabs(value));
+            if (!(row == 0 && (column == 2 || column == 5))) // MOA is NaN at the muzzle
+               columnError = fmax(columnError, fabs(file.Value(row, (EPathColumn)(1 << column)) - value));
+         }
+         if (largest > 0 && columnError/largest > error)
+         {
+            error = columnError/largest;
+            worst = column;
+         }
+      }
+
+      ProjectilePath row, before, after;
+      file.GetRow(500, before);
+      file.GetRow(501, after);
+      int inside = file.Interpolate(500.25, row) && !file.Interpolate(1000.5, row) && file.Interpolate(1000, row);
+      file.Interpolate(500.25, row);
+      bool interpolated = inside && fabs(row.Path - (0.75*before.Path + 0.25*after.Path)) < 1e-9;
+
+      Check(described && error <= tolerance[encoding] && interpolated, Format("Trajectory file %s", EncodingNames[encoding]).c_str(),
+         Format("%s, values within %.2g of the table (%s column), %s interpolation", described ? "header read" : "bad header",
+            error, PathColumnNames[worst], interpolated ? "right" : "wrong"));
+      file.Close();
+   }
+
+   // Damaged files are refused.
+   std::vector<unsigned char> data = EncodeTrajectoryFile(request, result, TRAJECTORY_DELTA32);
+   TrajectoryFile file;
+   int truncated = file.Open(data.data(), data.size() - 8);
+   data[4] = 2;
+   int versioned = file.Open(data.data(), data.size());
+   int missing = file.Open("no such file");
+   Check(!truncated && !versioned && !missing, "Trajectory file validation",
+      Format("truncated %s, other version %s, missing file %s", truncated ? "opened" : "refused", versioned ? "opened" : "refused", missing ? "opened" : "refused"));
+   remove(TrajectoryFileName);
+}
+
+static void CheckAtmosphere()
+{
+   std::vector<Atmosphere> weather = MakeWeather(10000);
+   std::vector<double> batch(weather.size());
+   CorrectDragCoefficients(0.3, weather.data(), batch.data(), (int)weather.size());
+
+   double error = 0;
+   int mismatches = 0;
+   for (size_t i = 0; i < weather.size(); i++)
+   {
+      double reference = ReferenceAtmosphericCorrection(weather[i]);
+      error = fmax(error, fabs(AtmosphericCorrection(weather[i]) / reference - 1));
+
+      Projectile projectile(0.3, G1, 2700, 1.5);
+      projectile.DragCoefficientAtmosphericCorrection(weather[i].Altitude_feet, weather[i].Barometer_hg, weather[i].Temperature_f, weather[i].RelativeHumidity);
+      double shared[2] = { 0.3, 0.6 }, corrected[2];
+      CorrectDragCoefficients(shared, weather[i], corrected, 2);
+      if (projectile.DragCoefficient != batch[i] || corrected[0] != batch[i] || corrected[1] != 2*batch[i])
+         mismatches++;
+   }
+
+   Check(error <= 1e-13 && mismatches == 0, "Atmospheric correction",
+      Format("within %.2g of the pow formula; %d of %d batch or Projectile corrections differ", error, mismatches, (int)weather.size()));
+}
+
+static void CheckRangeCard()
+{
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      Projectile projectile = MakeProjectile((EIntegrator)integrator);
+      double angle = projectile.CalculateSightToBoreAngle(100, 0);
+      projectile.Fire(0, angle);
+      std::vector<RangeCardWind> winds = MakeCardWinds(true);
+      RangeCard card;
+      int rows = SolveRangeCard(projectile, 25, 1000, winds.data(), (int)winds.size(), card);
+
+      // Each wind's rows, against a SolveTable of its own.
+      int columns = PathColumnCount(PATH_ALL);
+      std::vector<double> table(PathTableRows(1000, 25) * columns);
+      double error = 0;
+      int reached = 1;
+      for (size_t w = 0; w < winds.size(); w++)
+      {
+         Projectile flight = projectile;
+         reached &= SolveTable(winds[w].Speed_mile_hr, winds[w].Angle, flight, 25, 1000, PATH_ALL, table.data()) == rows;
+         for (int r = 1; r < rows; r++)
+         {
+            ProjectilePath row = card.Row((int)w, r);
+            const double* expected = &table[r*columns];
+            const double got[7] = { row.Range, row.Path, row.MOA, row.Time, row.Windage, row.WindageMOA, row.Velocity };
+            for (int c = 0; c < 7; c++)
+               error = fmax(error, fabs(got[c] - expected[c]) / fmax(1, fabs(expected[c])));
+         }
+      }
+
+      Check(reached && rows == 41 && card.FlightCount == 5 && error <= 1e-12, Format("Range card %s", IntegratorNames[integrator]).c_str(),
+         Format("%d winds in %d flights, %d rows, within %.2g of SolveTable", (int)winds.size(), card.FlightCount, rows, error));
+   }
+}
+
+// Whether two solutions have the same rows, to the bit.
+static bool SameRows(const ZonedSolution& a, const ZonedSolution& b)
+{
+   return a.RowCount() == b.RowCount() && memcmp(a.Rows(), b.Rows(), a.RowCount()*sizeof(ProjectilePath)) == 0;
+}
+
+static void CheckWindZones()
+{
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      Projectile projectile = MakeProjectile((EIntegrator)integrator);
+      double angle = projectile.CalculateSightToBoreAngle(100, 0);
+      projectile.Fire(0, angle);
+
+      // One zone, against SolveAll.
+      Projectile flight = projectile;
+      flight.RecordPath(1000, 1);
+      int rows = SolveAll(10, 60, flight);
+      WindZone calm = { 1000, 10, 60 };
+      ZonedSolution single(projectile, 1, 1000);
+      int reached = single.Solve(&calm, 1) == rows;
+      double error = 0;
+      for (int r = 1; r < rows; r++)
+      {
+         const ProjectilePath& a = single.Rows()[r];
+         const ProjectilePath& b = flight.aProjectilePath[r];
+         const double got[9] = { a.Range, a.Path, a.MOA, a.Time, a.Windage, a.WindageMOA, a.Velocity, a.Vx, a.Vy };
+         const double expected[9] = { b.Range, b.Path, b.MOA, b.Time, b.Windage, b.WindageMOA, b.Velocity, b.Vx, b.Vy };
+         for (int c = 0; c < 9; c++)
+            error = fmax(error, fabs(got[c] - expected[c]) / fmax(1, fabs(expected[c])));
+      }
+
+      // The same wind in four zones flies the same flight, and has the same windage.
+      WindZone same[4] = { { 250, 10, 60 }, { 500, 10, 60 }, { 750, 10, 60 }, { 1000, 10, 60 } };
+      ZonedSolution split(projectile, 1, 1000);
+      split.Solve(same, 4);
+
+      // Changing the last zone resumes at it, and changing only a crosswind flies nothing; either way,
+      // the rows are those of solving the new zones afresh.
+      ZonedSolution solution(projectile, 1, 1000);
+      std::vector<WindZone> zones = MakeWindZones(10, 30);
+      solution.Solve(zones.data(), 4);
+      zones[3].Speed_mile_hr = 20;
+      solution.Solve(zones.data(), 4);
+      ZonedSolution fresh(projectile, 1, 1000);
+      fresh.Solve(zones.data(), 4);
+      int resumed = solution.ResumedZone();
+      bool tail = resumed == 3 && SameRows(solution, fresh);
+
+      zones[1].Angle = -zones[1].Angle;
+      solution.Solve(zones.data(), 4);
+      ZonedSolution crossed(projectile, 1, 1000);
+      crossed.Solve(zones.data(), 4);
+      bool crosswind = solution.ResumedZone() == 4 && SameRows(solution, crossed);
+
+      // An empty list of zones is turned away, and the last solution stands.
+      ZonedSolution none(projectile, 1, 1000);
+      bool empty = none.Solve(zones.data(), 0) == 0 && solution.Solve(zones.data(), 0) == 0 && SameRows(solution, crossed)
+         && solution.Solve(zones.data(), 4) == crossed.RowCount() && SameRows(solution, crossed);
+
+      Check(reached && error <= 1e-12 && SameRows(single, split) && tail && crosswind && empty, Format("Wind zones %s", IntegratorNames[integrator]).c_str(),
+         Format("%d rows, within %.2g of SolveAll; split zones %s; tail resumed at zone %d, %s; crosswind %s; no zones %s",
+            rows, error, SameRows(single, split) ? "agree" : "differ", resumed,
+            tail ? "agrees" : "differs", crosswind ? "agrees" : "differs", empty ? "rejected" : "accepted"));
+   }
+}
+
+#define PRECISION_MARKS 20 // every 100 yards, out to 2000
+
+// Flies rounds in a batch of some precision, and notes the drop (in inches) and the time of flight at
+// each mark, interpolated between the steps on either side.  Like SolveAll's, the batch's t runs a step
+// ahead of its x, so the time of the state is t - dt.  Returns the number of rounds that reached the last mark.
+template <class Batch>
+static int FlyPrecisionBatch(const std::vector<PrecisionRound>& Rounds, std::vector<double>& Drop, std::vector<double>& Time)
+{
+   int count = (int)Rounds.size();
+   Batch batch(Rounds[0].DragFunction, count);
+   for (int i = 0; i < count; i++)
+      batch.Add(Rounds[i].DragCoefficient, Rounds[i].MuzzleVelocity, 1.6, 0, Rounds[i].SightToBoreAngle);
+
+   Drop.assign(count * PRECISION_MARKS, 0);
+   Time.assign(count * PRECISION_MARKS, 0);
+   std::vector<int> mark(count, 0);
+   std::vector<double> x(count), y(count), t(count);
+   int finished = 0;
+   while (batch.Count > 0 && finished < count)
+   {
+      for (int i = 0; i < batch.Count; i++)
+      {
+         x[batch.Id[i]] = batch.x[i];
+         y[batch.Id[i]] = batch.y[i];
+         t[batch.Id[i]] = batch.t[i] - batch.dt[i];
+      }
+      batch.Update(0);
+
+      for (int i = 0; i < batch.Count; i++)
+      {
+         int id = batch.Id[i];
+         while (mark[id] < PRECISION_MARKS && batch.x[i] >= 300.0 * (mark[id] + 1))
+         {
+            double f = (300.0 * (mark[id] + 1) - x[id]) / (batch.x[i] - x[id]);
+            Drop[id*PRECISION_MARKS + mark[id]] = 12 * (y[id] + f * (batch.y[i] - y[id]));
+            Time[id*PRECISION_MARKS + mark[id]] = t[id] + f * ((batch.t[i] - batch.dt[i]) - t[id]);
+            if (++mark[id] == PRECISION_MARKS)
+               finished++;
+         }
+      }
+   }
+   return finished;
+}
+
+// Flies each round on its own, as SolveAll does, with Projectile::Update's steps, and notes the drop and
+// the windage (in inches) in a 10 mi/hr crosswind at each mark, interpolated by SolveRanges between the
+// steps on either side.  Returns the number of rounds that reached the last mark.
+static int FlyPrecisionReference(const std::vector<PrecisionRound>& Rounds, std::vector<double>& Drop, std::vector<double>& Windage)
+{
+   double ranges[PRECISION_MARKS];
+   for (int m = 0; m < PRECISION_MARKS; m++)
+      ranges[m] = 100.0 * (m + 1);
+
+   int count = (int)Rounds.size();
+   Drop.assign(count * PRECISION_MARKS, 0);
+   Windage.assign(count * PRECISION_MARKS, 0);
+   int finished = 0;
+   for (int r = 0; r < count; r++)
+   {
+      Projectile projectile(Rounds[r].DragCoefficient, Rounds[r].DragFunction, Rounds[r].MuzzleVelocity, 1.6);
+      projectile.Fire(0, Rounds[r].SightToBoreAngle);
+      ProjectilePath rows[PRECISION_MARKS];
+      if (SolveRanges(10, 90, projectile, ranges, PRECISION_MARKS, rows) == PRECISION_MARKS)
+         finished++;
+      for (int m = 0; m < PRECISION_MARKS; m++)
+      {
+         Drop[r*PRECISION_MARKS + m] = rows[m].Path;
+         Windage[r*PRECISION_MARKS + m] = rows[m].Windage;
+      }
+   }
+   return finished;
+}
+
+// What each precision of the batch costs in drop and windage, in a 10 mi/hr crosswind out to 2000 yards,
+// against the same rounds flown one by one with Projectile::Update.  The batch's windage comes from its
+// time of flight at each mark, through WindageCorrection, as SolveAll's does.
+static void CheckPrecision()
+{
+   const EDragFunction dragFunctions[2] = { G1, G7 };
+   for (int d = 0; d < 2; d++)
+   {
+      std::vector<PrecisionRound> rounds = MakePrecisionRounds(dragFunctions[d], 64);
+      std::vector<double> referenceDrop, referenceWindage;
+      int referenceReached = FlyPrecisionReference(rounds, referenceDrop, referenceWindage);
+
+      std::vector<double> drop[3], time[3];
+      int reached[3];
+      reached[0] = FlyPrecisionBatch<ProjectileBatch>(rounds, drop[0], time[0]);
+      reached[1] = FlyPrecisionBatch<MixedProjectileBatch>(rounds, drop[1], time[1]);
+      reached[2] = FlyPrecisionBatch<SingleProjectileBatch>(rounds, drop[2], time[2]);
+
+      const char* names[3] = { "double", "mixed", "single" };
+      for (int p = 0; p < 3; p++)
+      {
+         // The worst errors at 1000 yards, and at any mark out to 2000.
+         double dropError[2] = { 0, 0 }, windageError[2] = { 0, 0 };
+         for (size_t r = 0; r < rounds.size(); r++)
+         {
+            Projectile projectile(rounds[r].DragCoefficient, rounds[r].DragFunction, rounds[r].MuzzleVelocity, 1.6);
+            for (int m = 0; m < PRECISION_MARKS; m++)
+            {
+               size_t k = r*PRECISION_MARKS + m;
+               double windage = projectile.WindageCorrection(CrossWindVelocity(10, 90), rounds[r].MuzzleVelocity, 300.0 * (m + 1), time[p][k]);
+               int far = m >= PRECISION_MARKS/2 ? 1 : 0;
+               dropError[far] = fmax(dropError[far], fabs(drop[p][k] - referenceDrop[k]));
+               windageError[far] = fmax(windageError[far], fabs(windage - referenceWindage[k]));
+            }
+         }
+         dropError[1] = fmax(dropError[1], dropError[0]);
+         windageError[1] = fmax(windageError[1], windageError[0]);
+
+         const double dropBound[3] = { 0.001, 0.05, 0.5 }, windageBound[3] = { 0.001, 0.005, 0.1 };
+         Check(reached[p] == referenceReached && referenceReached == (int)rounds.size() && dropError[1] < dropBound[p] && windageError[1] < windageBound[p],
+            Format("Precision %s %s", names[p], DragFunctionNames[dragFunctions[d]]).c_str(),
+            Format("drop within %.2g in at 1000 yd, %.2g in at 2000 yd; windage within %.2g, %.2g in",
+               dropError[0], dropError[1], windageError[0], windageError[1]));
+      }
+   }
+}
+
+static void CheckInverseIndex()
+{
+   int columns = PathColumnCount(PATH_ALL);
+   for (int integrator = Trapezoidal; integrator <= RK45; integrator++)
+   {
+      // A row every yard, and every 25 yards.
+      InverseIndex fine, coarse;
+      std::vector<double> table = MakeInverseTable((EIntegrator)integrator, 200, 1, fine);
+      MakeInverseTable((EIntegrator)integrator, 200, 25, coarse);
+      int rows = fine.RowCount();
+
+      // The trapezoidal rule's first row is where its step passes 1 yard, at a time that leads its range
+      // by about 0.4 ms, so it gets bounds that allow for that across the first 25 yards.
+      bool rk45 = integrator == RK45;
+
+      // The coarse index between its rows, against the fine table's rows.
+      double pathError = 0, timeError = 0;
+      for (int r = 0; r < rows; r++)
+      {
+         ProjectilePath row;
+         coarse.Interpolate(table[r*columns], row);
+         pathError = fmax(pathError, fabs(row.Path - table[r*columns + 1]));
+         timeError = fmax(timeError, fabs(row.Time - table[r*columns + 3]));
+      }
+      Check(rows == 1001 && pathError < (rk45 ? 1e-4 : 2e-3) && timeError < (rk45 ? 1e-6 : 5e-4), Format("Inverse index interpolation %s", IntegratorNames[integrator]).c_str(),
+         Format("25 yd rows within %.2g in and %.2g s", pathError, timeError));
+
+      // Each query, against a scan of the fine table for the rows on either side of each crossing, and
+      // the value the index interpolates at each range it finds.
+      const EPathColumn queryColumns[3] = { PATH_PATH, PATH_MOA, PATH_TIME };
+      const double queries[3][5] = { { -1.5, -100, 0, 1, 2.8 }, { 10, 0, 0.4, -0.5, -0.6 }, { 0.01, 0.1, 0.5, 1, 1.5 } };
+      int missed = 0;
+      double valueError = 0, rangeError = 0;
+      for (int q = 0; q < 3; q++)
+      {
+         int field = PathColumnCount(PATH_ALL & (queryColumns[q]-1));
+         for (int v = 0; v < 5; v++)
+         {
+            double value = queries[q][v];
+            double ranges[2], coarseRanges[2];
+            int count = fine.RangesAt(queryColumns[q], value, ranges, 2);
+            int coarseCount = coarse.RangesAt(queryColumns[q], value, coarseRanges, 2);
+
+            int crossings = 0;
+            for (int r = 0; r + 1 < rows; r++)
+            {
+               if ((table[r*columns + field] < value) != (table[(r+1)*columns + field] < value))
+               {
+                  bool found = false;
+                  for (int i = 0; i < count && i < 2; i++)
+                     found |= ranges[i] >= table[r*columns] && ranges[i] <= table[(r+1)*columns];
+                  missed += !found;
+                  crossings++;
+               }
+            }
+            missed += (count != crossings) + (coarseCount != count);
+
+            for (int i = 0; i < count && i < 2; i++)
+            {
+               ProjectilePath row;
+               fine.Interpolate(ranges[i], row);
+               double got = (q == 0) ? row.Path : (q == 1) ? row.MOA : row.Time;
+               valueError = fmax(valueError, fabs(got - value));
+               if (i < coarseCount)
+                  rangeError = fmax(rangeError, fabs(coarseRanges[i] - ranges[i]));
+            }
+         }
+      }
+      Check(missed == 0 && valueError < 1e-9 && rangeError < (rk45 ? 1e-3 : 0.5), Format("Inverse index queries %s", IntegratorNames[integrator]).c_str(),
+         Format("%d missed, values within %.2g, 25 yd rows within %.2g yd", missed, valueError, rangeError));
+
+      // The maximum point blank range for a 10 inch zone, against a flight zeroed at its far zero.
+      PointBlank blank, coarseBlank;
+      bool found = fine.PointBlankRange(10, blank) && coarse.PointBlankRange(10, coarseBlank);
+      InverseIndex rezeroed;
+      std::vector<double> flight = MakeInverseTable((EIntegrator)integrator, blank.FarZero_yard, 1, rezeroed);
+      double top = -1e9;
+      for (int r = 0; r < rezeroed.RowCount(); r++)
+         top = fmax(top, flight[r*columns + 1]);
+      double bottom[2];
+      int bottoms = rezeroed.RangesAt(PATH_PATH, -5, bottom, 2);
+      double maxRange = bottom[bottoms-1];
+      Check(found && fabs(top - 5) < 0.01 && fabs(maxRange - blank.Range_yard) < 0.5 && fabs(coarseBlank.Range_yard - blank.Range_yard) < 0.05,
+         Format("Inverse index point blank %s", IntegratorNames[integrator]).c_str(),
+         Format("%.1f yd zeroed at %.1f yd; flown, tops %.3f in and leaves at %.1f yd", blank.Range_yard, blank.FarZero_yard, top, maxRange));
+   }
+}
+
+// SolutionCache must return what SolveOne gives for the quantized request, count its hits and misses,
+// evict the least recently used solution, and agree with itself when hammered from several threads.
+static void CheckSolutionCache()
+{
+   std::vector<SolutionRequest> requests = MakeRequests(16, Trapezoidal);
+   SolutionCache cache(8);
+
+   int mismatches = 0;
+   Projectile scratch(1, G1, 1, 0);
+   for (size_t i = 0; i < requests.size(); i++)
+   {
+      SolutionRequest jittered = requests[i];
+      jittered.MuzzleVelocity += 0.2;
+      jittered.Temperature_f -= 0.1;
+
+      std::shared_ptr<const SolutionResult> cached = cache.Solve(jittered);
+      SolutionResult expected;
+      BatchSolver::SolveOne(cache.Quantize(requests[i]), scratch, expected);
+      if (cached->RowCount != expected.RowCount || cached->SightToBoreAngle != expected.SightToBoreAngle ||
+         memcmp(cached->Table.data(), expected.Table.data(), expected.Table.size() * sizeof(double)) != 0)
+         mismatches++;
+   }
+   Check(mismatches == 0, "SolutionCache results", Format("%d of %d differ from SolveOne", mismatches, (int)requests.size()));
+
+   // The last 8 requests are cached; the first 8 were evicted.
+   long long hits = cache.Hits(), misses = cache.Misses();
+   for (size_t i = 8; i < requests.size(); i++)
+      cache.Solve(requests[i]);
+   cache.Solve(requests[0]);
+   Check(cache.Hits() - hits == 8 && cache.Misses() - misses == 1 && cache.Size() == 8, "SolutionCache LRU",
+      Format("%lld hits, %lld misses, %d held", cache.Hits() - hits, cache.Misses() - misses, cache.Size()));
+
+   SolutionRequest windy = requests[0];
+   windy.WindSpeed_mile_hr += 5;
+   long long zeroHits = cache.ZeroHits();
+   cache.Solve(windy);
+   Check(cache.ZeroHits() - zeroHits == 1, "SolutionCache zero reuse", "");
+
+   SolutionCache shared(16);
+   std::vector<std::shared_ptr<const SolutionResult> > first(requests.size());
+   for (size_t i = 0; i < requests.size(); i++)
+      first[i] = cache.Solve(requests[i]);
+   std::atomic<int> differences(0);
+   std::vector<std::thread> threads;
+   for (int t = 0; t < 4; t++)
+      threads.push_back(std::thread([&, t]
+      {
+         for (int n = 0; n < 200; n++)
+         {
+            size_t i = (n * 7 + t) % requests.size();
+            std::shared_ptr<const SolutionResult> r = shared.Solve(requests[i]);
+            if (r->Table.size() != first[i]->Table.size() || memcmp(r->Table.data(), first[i]->Table.data(), r->Table.size() * sizeof(double)) != 0)
+               differences++;
+         }
+      }));
+   for (size_t t = 0; t < threads.size(); t++)
+      threads[t].join();
+   Check(differences == 0 && shared.Hits() + shared.Misses() == 800, "SolutionCache threads",
+      Format("%d of 800 lookups differ, %lld hits, %lld misses", (int)differences, shared.Hits(), shared.Misses()));
+}
+
+static int RunChecks()
+{
+   CheckGolden();
+   CheckDrag();
+   CheckAtmosphere();
+   CheckSolveRanges();
+   CheckSolveTableRecording();
+   CheckRangeCard();
+   CheckWindZones();
+   CheckInverseIndex();
+   CheckStandardDrag<G1>();
+   CheckStandardDrag<G2>();
+   CheckStandardDrag<G5>();
+   CheckStandardDrag<G6>();
+   CheckStandardDrag<G7>();
+   CheckStandardDrag<G8>();
+   CheckBasicProjectile();
+   CheckUpdateRK45();
+   CheckAdvance();
+#ifdef BALLISTICS_INSTRUMENT
+   CheckInstrument();
+#endif
+   CheckBatchSteps();
+   CheckBatch();
+   CheckPrecision();
+   CheckSolutionCache();
+   CheckDispersion();
+   CheckTrajectoryFile();
+   printf("%d failed\n", Failures);
+   return Failures ? 1 : 0;
+}
+
+// Prints golden.h for the cases it already holds, solved by the current code, with the trapezoidal rows
+// read from Trapezoidal instead, if it is given.
+static int PrintGolden(FILE* Trapezoidal)
+{
+   printf("// Golden trajectories for the accuracy check in checks.cpp.\n");
+   if (Trapezoidal)
+   {
+      printf("// Generated by \"checks --golden\": the zeros and the RK45 rows by the library, and the trapezoidal rows by\n");
+      printf("// baselinegolden.cpp, with the baseline Projectile::Update and SolveAll (commit d13d086).\n");
+   }
+   else
+      printf("// Generated by \"checks --golden\", all by the library.\n");
+   printf("// See checks.cpp and baselinegolden.cpp before regenerating.\n\n");
+   printf("#ifndef _GOLDEN_\n#define _GOLDEN_\n\n");
+   printf("#define GOLDEN_CASES %d\n#define GOLDEN_ROWS %d\n#define GOLDEN_STEP %d // yards between rows\n#define GOLDEN_COLUMNS %d // path, time, windage, velocity\n\n",
+      GOLDEN_CASES, GOLDEN_ROWS, GOLDEN_STEP, GOLDEN_COLUMNS);
+   printf("struct GoldenCase\n{\n   const char* Name;\n   EDragFunction DragFunction;\n   double DragCoefficient;\n   double MuzzleVelocity;\n   double SightHeightOverBore;\n");
+   printf("   EIntegrator Integrator;\n   double Altitude_feet;\n   double Temperature_f;\n   double ZeroRange_yard;\n   double WindSpeed_mile_hr;\n   double WindAngle;\n\n");
+   printf("   double SightToBoreAngle;\n   double Rows[GOLDEN_ROWS][GOLDEN_COLUMNS];\n};\n\n");
+   printf("static const GoldenCase GoldenCases[GOLDEN_CASES] =\n{\n");
+   for (int k = 0; k < GOLDEN_CASES; k++)
+   {
+      const GoldenCase& c = GoldenCases[k];
+      double rows[GOLDEN_ROWS][GOLDEN_COLUMNS];
+      double angle = SolveGolden(c, RK45_TOLERANCE, rows);
+      if (Trapezoidal && c.Integrator == ::Trapezoidal)
+         for (int i = 0; i < GOLDEN_ROWS; i++)
+            if (fscanf(Trapezoidal, "%lf %lf %lf %lf", &rows[i][0], &rows[i][1], &rows[i][2], &rows[i][3]) != GOLDEN_COLUMNS)
+            {
+               fprintf(stderr, "too few trapezoidal rows\n");
+               return 1;
+            }
+
+      printf("   {\n      \"%s\", %s, %.17g, %.17g, %.17g, %s, %.17g, %.17g, %.17g, %.17g, %.17g,\n      %.17g,\n      {\n",
+         c.Name, DragFunctionNames[c.DragFunction], c.DragCoefficient, c.MuzzleVelocity, c.SightHeightOverBore, IntegratorNames[c.Integrator],
+         c.Altitude_feet, c.Temperature_f, c.ZeroRange_yard, c.WindSpeed_mile_hr, c.WindAngle, angle);
+      for (int i = 0; i < GOLDEN_ROWS; i++)
+         printf("         { %.17g, %.17g, %.17g, %.17g },\n", rows[i][0], rows[i][1], rows[i][2], rows[i][3]);
+      printf("      }\n   },\n");
+   }
+   printf("};\n\n#endif\n");
+   return 0;
+}
+
+int main(int argc, char** argv)
+{
+   if (argc >= 2 && argc <= 3 && strcmp(argv[1], "--golden") == 0)
+   {
+      FILE* trapezoidal = NULL;
+      if (argc == 3 && !(trapezoidal = fopen(argv[2], "r")))
+      {
+         fprintf(stderr, "cannot open %s\n", argv[2]);
+         return 1;
+      }
+      int result = PrintGolden(trapezoidal);
+      if (trapezoidal)
+         fclose(trapezoidal);
+      return result;
+   }
+   return RunChecks();
+}
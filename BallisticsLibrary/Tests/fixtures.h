@@ -0,0 +1,189 @@
+// GNU Ballistics Library
+// Originally created by Derek Yates
+// Now available free under the GNU GPL
+
+// The projectiles, requests and inputs the checks and the benchmark share, so that the benchmark
+// times what the checks verify.
+
+#ifndef _FIXTURES_
+#define _FIXTURES_
+
+#include <math.h>
+#include <vector>
+
+#include "ballistics.h"
+#include "atmosphere.h"
+#include "rangecard.h"
+#include "windzones.h"
+#include "inverseindex.h"
+#include "batchsolver.h"
+#include "dispersion.h"
+
+static const EDragFunction DragFunctions[] = { G1, G2, G5, G6, G7, G8 };
+static const char* const DragFunctionNames[] = { "", "G1", "G2", "G3", "G4", "G5", "G6", "G7", "G8" };
+static const char* const IntegratorNames[] = { "Trapezoidal", "RK45" };
+
+// A .308 Winchester 168 gr match load, zeroed at 200 yards: the demo's projectile.
+inline Projectile MakeProjectile(EIntegrator Integrator)
+{
+   Projectile projectile(0.465, G1, 2650, 1.6);
+   projectile.Integrator = Integrator;
+   return projectile;
+}
+
+// The rounds the precision checks and benchmark fly: a spread of coefficients and velocities, each
+// zeroed at 200 yards in double.
+struct PrecisionRound
+{
+   EDragFunction DragFunction;
+   double DragCoefficient;
+   double MuzzleVelocity;
+   double SightToBoreAngle;
+};
+
+inline std::vector<PrecisionRound> MakePrecisionRounds(EDragFunction DragFunction, int Count)
+{
+   std::vector<PrecisionRound> rounds(Count);
+   for (int i = 0; i < Count; i++)
+   {
+      PrecisionRound& round = rounds[i];
+      round.DragFunction = DragFunction;
+      round.DragCoefficient = (DragFunction == G7 ? 0.2 : 0.35) + 0.3 * i / Count;
+      round.MuzzleVelocity = 2400 + 700.0 * ((i * 7) % Count) / Count;
+      Projectile projectile(round.DragCoefficient, DragFunction, round.MuzzleVelocity, 1.6);
+      round.SightToBoreAngle = projectile.CalculateSightToBoreAngle(200, 0);
+   }
+   return rounds;
+}
+
+// The atmospheric correction as the library first computed it, with pow, for reference.
+inline double ReferenceAtmosphericCorrection(const Atmosphere& w)
+{
+   double FA = 1/(-4e-15 * pow(w.Altitude_feet,3) + 4e-10 * pow(w.Altitude_feet,2) - 3e-5 * w.Altitude_feet + 1);
+   double Tstd = -0.0036 * w.Altitude_feet + 59;
+   double FT = (w.Temperature_f-Tstd) / (459.6 + Tstd);
+   double VPw = 4e-6 * pow(w.Temperature_f,3) - 0.0004 * pow(w.Temperature_f,2) + 0.0234 * w.Temperature_f - 0.2517;
+   double FR = 0.995 * (w.Barometer_hg / (w.Barometer_hg-(0.3783) * (w.RelativeHumidity) * VPw));
+   double FP = (w.Barometer_hg-29.53) / 29.53;
+   return FA*(1+FT-FP)*FR;
+}
+
+// Weather samples spread over 0 to 15000 ft, -40 to 120 degrees F, 25 to 31 in Hg and all humidities.
+inline std::vector<Atmosphere> MakeWeather(int Count)
+{
+   std::vector<Atmosphere> weather(Count);
+   for (int i = 0; i < Count; i++)
+   {
+      weather[i].Altitude_feet = fmod(i * 7919.3, 15000);
+      weather[i].Temperature_f = -40 + fmod(i * 37.77, 160);
+      weather[i].Barometer_hg = 25 + fmod(i * 0.613, 6);
+      weather[i].RelativeHumidity = fmod(i * 0.0731, 1);
+   }
+   return weather;
+}
+
+// A dope card: 5, 10, 15 and 20 mi/hr winds from each side, and quartering from the front, which
+// fly as 1 + 4 distinct headwinds.
+inline std::vector<RangeCardWind> MakeCardWinds(bool Quartering)
+{
+   std::vector<RangeCardWind> winds;
+   for (int speed = 5; speed <= 20; speed += 5)
+   {
+      const double angles[4] = { 90, 270, 45, 315 };
+      for (int a = 0; a < (Quartering ? 4 : 2); a++)
+      {
+         RangeCardWind wind = { (double)speed, angles[a] };
+         winds.push_back(wind);
+      }
+   }
+   return winds;
+}
+
+// Four wind zones out to 1000 yards, the last of which the spotter calls as Speed_mile_hr from Angle.
+inline std::vector<WindZone> MakeWindZones(double Speed_mile_hr, double Angle)
+{
+   const WindZone zones[4] = { { 250, 5, 90 }, { 500, 8, 60 }, { 750, 12, 300 }, { 1000, Speed_mile_hr, Angle } };
+   return std::vector<WindZone>(zones, zones + 4);
+}
+
+// A zeroed flight's table, out to 1000 yards, and an index of it.
+inline std::vector<double> MakeInverseTable(EIntegrator Integrator, double ZeroRange_yard, double RangeStep_yard, InverseIndex& Index)
+{
+   Projectile projectile = MakeProjectile(Integrator);
+   projectile.Fire(0, projectile.CalculateSightToBoreAngle(ZeroRange_yard, 0));
+   std::vector<double> table(PathTableRows(1000, RangeStep_yard) * PathColumnCount(PATH_ALL));
+   int rows = SolveTable(0, 0, projectile, RangeStep_yard, 1000, PATH_ALL, table.data());
+   table.resize(rows * PathColumnCount(PATH_ALL));
+   Index.Build(table.data(), rows, PATH_ALL);
+   return table;
+}
+
+// The requests behind the batch benchmark and check: a spread of loads, zeros and winds.
+inline std::vector<SolutionRequest> MakeRequests(int Count, EIntegrator Integrator)
+{
+   std::vector<SolutionRequest> requests(Count);
+   for (int i = 0; i < Count; i++)
+   {
+      SolutionRequest& r = requests[i];
+      r.DragFunction = DragFunctions[i % 6];
+      r.DragCoefficient = 0.2 + 0.05 * (i % 7);
+      r.MuzzleVelocity = 2200 + 100 * (i % 9);
+      r.SightHeightOverBore = 1.5;
+      r.Integrator = Integrator;
+      r.Altitude_feet = 1000 * (i % 5);
+      r.Barometer_hg = 29.92;
+      r.Temperature_f = 20 + 10 * (i % 8);
+      r.RelativeHumidity = 0.5;
+      r.ZeroRange_yard = 100 + 50 * (i % 5);
+      r.yIntercept_inch = 0;
+      r.BoreAngle = -10 + (i % 21);
+      r.WindSpeed_mile_hr = i % 15;
+      r.WindAngle = 30 * (i % 12);
+      r.RangeStep_yard = 25;
+      r.MaxRange_yard = 1000;
+      r.Columns = PATH_ALL;
+   }
+   return requests;
+}
+
+// A 600 yd shot at an 18 inch square, with typical uncertainty in every input.
+inline DispersionRequest MakeDispersionRequest(int Count, EIntegrator Integrator)
+{
+   DispersionRequest r = {};
+   r.DragFunction = G7;
+   r.Integrator = Integrator;
+   r.DragCoefficient.Mean = 0.305;
+   r.DragCoefficient.Sigma = 0.005;
+   r.MuzzleVelocity.Mean = 2710;
+   r.MuzzleVelocity.Sigma = 12;
+   r.SightHeightOverBore = 1.5;
+   r.Altitude_feet = 0;
+   r.Barometer_hg = 29.92;
+   r.Temperature_f = 59;
+   r.RelativeHumidity = 0.7;
+   r.ZeroRange_yard = 100;
+   r.WindSpeed_mile_hr.Mean = 8;
+   r.WindSpeed_mile_hr.Sigma = 2;
+   r.WindAngle.Mean = 270;
+   r.WindAngle.Sigma = 20;
+   r.Range_yard.Mean = 600;
+   r.Range_yard.Sigma = 10;
+   r.Aim_moa = 0.5;
+   r.TargetWidth_inch = 18;
+   r.TargetHeight_inch = 18;
+   r.Count = Count;
+   r.Seed = 12345;
+   return r;
+}
+
+// A 1 yard table to 1000 yards, every column.
+inline SolutionRequest MakeTrajectoryRequest(SolutionResult& Result)
+{
+   SolutionRequest request = MakeRequests(1, RK45)[0];
+   request.RangeStep_yard = 1;
+   Projectile scratch(1, G1, 1, 0);
+   BatchSolver::SolveOne(request, scratch, Result);
+   return request;
+}
+
+#endif
@@ -0,0 +1,244 @@
+// Golden trajectories for the accuracy check in checks.cpp.
+// Generated by "checks --golden": the zeros and the RK45 rows by the library, and the trapezoidal rows by
+// baselinegolden.cpp, with the baseline Projectile::Update and SolveAll (commit d13d086).
+// See checks.cpp and baselinegolden.cpp before regenerating.
+
+#ifndef _GOLDEN_
+#define _GOLDEN_
+
+#define GOLDEN_CASES 8
+#define GOLDEN_ROWS 20
+#define GOLDEN_STEP 50 // yards between rows
+#define GOLDEN_COLUMNS 4 // path, time, windage, velocity
+
+struct GoldenCase
+{
+   const char* Name;
+   EDragFunction DragFunction;
+   double DragCoefficient;
+   double MuzzleVelocity;
+   double SightHeightOverBore;
+   EIntegrator Integrator;
+   double Altitude_feet;
+   double Temperature_f;
+   double ZeroRange_yard;
+   double WindSpeed_mile_hr;
+   double WindAngle;
+
+   double SightToBoreAngle;
+   double Rows[GOLDEN_ROWS][GOLDEN_COLUMNS];
+};
+
+static const GoldenCase GoldenCases[GOLDEN_CASES] =
+{
+   {
+      "G1 trapezoidal", G1, 0.46500000000000002, 2650, 1.6000000000000001, Trapezoidal, 0, 59, 200, 10, 90,
+      0.10004979763260953,
+      {
+         { 0.91450710740532082, 0.058242448846008654, 0.25706189026795911, 2553.0238039755041 },
+         { 2.0845947663631454, 0.11812024224718186, 0.83517206379620457, 2458.4324797903714 },
+         { 1.8160702733138612, 0.18032244735065694, 1.8224097702862898, 2365.7762040601315 },
+         { -0.0059711656884391794, 0.24498272914320507, 3.2423076341060817, 2275.0756307069832 },
+         { -3.5078894474321149, 0.31224462273859838, 5.1201383794892976, 2186.2977629909597 },
+         { -8.8288955220384473, 0.38226320894047422, 7.4832071640058864, 2099.4917176842373 },
+         { -16.12253848490171, 0.45520274447064407, 10.360436653476707, 2014.7044831515798 },
+         { -25.558350403919356, 0.5312388959592409, 13.782760273117475, 1932.00214092852 },
+         { -37.323643505181742, 0.6105563580608302, 17.78270334862588, 1851.4777155581955 },
+         { -51.625414794227346, 0.69334897874659984, 22.394405783675744, 1773.2543960672913 },
+         { -68.692303548697581, 0.7798156644843881, 27.652901043807834, 1697.5242931723121 },
+         { -88.776391837681388, 0.87015544929396371, 33.593250343529391, 1624.5060690313971 },
+         { -112.15490158399741, 0.96456884834839085, 40.250788804253965, 1554.2353625204662 },
+         { -139.13222330188785, 1.0632571516216498, 47.660994596475909, 1486.8497017450193 },
+         { -170.15154703162557, 1.1667632084981829, 55.886272298310566, 1422.4195122289109 },
+         { -205.37036830972144, 1.2745685114164254, 64.901826954927941, 1361.6305603996618 },
+         { -245.27634389371065, 1.3871376931601869, 74.756319654974675, 1304.6635951123874 },
+         { -290.28667320717256, 1.5045412607776969, 85.462259407714512, 1251.8925710643007 },
+         { -340.83939044963142, 1.6267756593900056, 97.019141785189134, 1203.6466333331732 },
+         { -397.38607738076041, 1.7537553379342938, 109.41205708132583, 1160.1592266216296 },
+      }
+   },
+   {
+      "G1 RK45", G1, 0.46500000000000002, 2650, 1.6000000000000001, RK45, 0, 59, 200, 10, 90,
+      0.10003692359974435,
+      {
+         { 0.90830623863211657, 0.057665841842100413, 0.18692401326627495, 2553.3340272539172 },
+         { 2.0825667699449291, 0.11753265913847223, 0.7612197064843198, 2458.7278698869964 },
+         { 1.8181106828115721, 0.17972345291573374, 1.7445352603389521, 2366.0568835451868 },
+         { 3.3981344355060727e-07, 0.24437193238058832, 3.1604034952099593, 2275.3417912100281 },
+         { -3.4981660318562846, 0.31162168433934784, 5.0340956890082298, 2186.5495722683913 },
+         { -8.8156529983277263, 0.38162787102070445, 7.3929203939836086, 2099.729108360491 },
+         { -16.10607500163967, 0.45455484957902831, 10.265804469305195, 2014.9274498405919 },
+         { -25.539048380201685, 0.53057842482395579, 13.683689561469047, 1932.2103465611006 },
+         { -37.302021729085951, 0.6098835409683101, 17.679125851931992, 1851.6709141174751 },
+         { -51.602159902689195, 0.69266435351660016, 22.286284709487649, 1773.4321878440983 },
+         { -68.668322735021334, 0.77912018666099359, 27.540247191957519, 1697.6861204921299 },
+         { -88.7528992883624, 0.86945066183019415, 33.476146670793405, 1624.651487199088 },
+         { -112.13350209128251, 0.96385695653244852, 40.129390387446797, 1554.3636798805396 },
+         { -139.11508030803896, 1.062541324247225, 47.535574954304053, 1486.9602708834859 },
+         { -170.03155490465883, 1.1656963641835789, 55.728597832158982, 1422.720225582045 },
+         { -205.24642320177435, 1.2734924336802589, 64.738441912631217, 1361.8997644635206 },
+         { -245.15220260296439, 1.3860599712981319, 74.588064382433515, 1304.8993832673611 },
+         { -290.16769830817287, 1.503472193383993, 85.290351318601637, 1252.0936209228003 },
+         { -340.7330226470865, 1.6257286016381929, 96.845215020397418, 1203.8124141418452 },
+         { -397.30257754713682, 1.7527473934717868, 109.23825823216654, 1160.2898730897521 },
+      }
+   },
+   {
+      "G7 trapezoidal", G7, 0.30499999999999999, 2710, 1.5, Trapezoidal, 5000, 40, 100, 8, 270,
+      0.062787356605848457,
+      {
+         { -0.12642178625703396, 0.056579547365215574, -0.14800373819175966, 2645.4760722707942 },
+         { -0.0014867858891206447, 0.1139754477530793, -0.43693531411244035, 2581.9824193788882 },
+         { -1.1804692399092871, 0.17279109308960955, -0.92577963178574729, 2519.3023453196065 },
+         { -3.7290615251065944, 0.23307879398079839, -1.6219067695602833, 2457.4348943873906 },
+         { -7.7170943711536921, 0.29489343283228098, -2.533049613221801, 2396.3791110722591 },
+         { -13.218850619233963, 0.35829262221495239, -3.6673262496180166, 2336.1340410164494 },
+         { -20.313406826755035, 0.42333687492637978, -5.0332640207221617, 2276.6987321052543 },
+         { -29.085005548001192, 0.49008978674858344, -6.6398253811087891, 2218.0722357103537 },
+         { -39.623461443608633, 0.55861823299863711, -8.4964357156557373, 2160.253608106736 },
+         { -52.02460473542704, 0.62899258007434056, -10.613013289597568, 2103.241912087316 },
+         { -66.390765933179594, 0.70128691331385085, -13.000001519947876, 2047.0362188030249 },
+         { -82.83130622165325, 0.77557928261690057, -15.668403776012534, 1991.6356098603742 },
+         { -101.46319841915013, 0.85195196741706969, -18.629820937350317, 1937.0391797132888 },
+         { -122.41166400782781, 0.93049176275099843, -21.896491960367623, 1883.2460383918033 },
+         { -145.81087240374518, 1.0112902883426136, -25.481337729919456, 1830.2553146167561 },
+         { -171.80470938960801, 1.0944443228098697, -29.398008500094932, 1778.0661593574939 },
+         { -200.54762248856323, 1.1800561653096124, -33.660935259012462, 1726.6777498985557 },
+         { -232.20555202678992, 1.2682340271642634, -38.285385386182902, 1676.0892944920804 },
+         { -267.07817925607674, 1.3593999337279679, -43.304847222806792, 1626.1354091242636 },
+         { -305.12646297427506, 1.4530698253938668, -48.703144531162479, 1577.1472983440474 },
+      }
+   },
+   {
+      "G7 RK45", G7, 0.30499999999999999, 2710, 1.5, RK45, 5000, 40, 100, 8, 270,
+      0.062783953144332605,
+      {
+         { -0.12892979287456383, 0.056019354968002859, -0.094167245915467754, 2645.6852790941753 },
+         { 7.4599495372695834e-08, 0.1134084140067811, -0.38118882499610385, 2582.1852049866457 },
+         { -1.1750522307711133, 0.17221707116005214, -0.86808981859733381, 2519.4987604364574 },
+         { -3.7197857603941085, 0.23249765856776111, -1.5622385920234216, 2457.624939077381 },
+         { -7.704045299078583, 0.29430509360741353, -2.4713675120271419, 2396.5627402680989 },
+         { -13.20214373872787, 0.35769705034074051, -3.6035970865002493, 2336.3111849583888 },
+         { -20.293193248553941, 0.4227341119514828, -4.9674574277134171, 2276.8692835597217 },
+         { -29.061478747208341, 0.48947995510062381, -6.5719142095331469, 2218.2360366596567 },
+         { -39.596867453662028, 0.55800155137731644, -8.4263970317121224, 2160.4104398196205 },
+         { -51.995256299599561, 0.62836938413374521, -10.540829950237962, 2103.3914874742609 },
+         { -66.359061471342926, 0.70065768245889937, -12.925664420840343, 2047.1781764593966 },
+         { -82.797757861006289, 0.7749446785416666, -15.59191553571463, 1991.7695145663088 },
+         { -101.4284644174318, 0.85131287665061428, -18.551199895875122, 1937.1645180504793 },
+         { -122.37658445994222, 0.92984934119770368, -21.815776170525972, 1883.3622063492001 },
+         { -145.77651415355223, 1.0106460157377579, -25.398590012186286, 1830.3616052955754 },
+         { -171.77242231388715, 1.093800069030205, -29.313322782183494, 1778.1617504736803 },
+         { -200.5191096731528, 1.1794142706610005, -33.574444438220155, 1726.7616905435332 },
+         { -232.18295699734949, 1.2675973992804246, -38.197271014255733, 1676.1604906798268 },
+         { -266.94297271237542, 1.3584646868803463, -43.198027174745384, 1626.3572362664052 },
+         { -304.99195215673831, 1.4521383029528296, -48.593914384171747, 1577.3510369881456 },
+      }
+   },
+   {
+      "G2 trapezoidal", G2, 0.40000000000000002, 2400, 2, Trapezoidal, 2000, 80, 300, 15, 45,
+      0.16720961709145116,
+      {
+         { 2.5002102369819994, 0.063767322373079457, 0.19890767473423474, 2351.7142470000908 },
+         { 5.4112173748707324, 0.1282103275329696, 0.5628332016641252, 2303.9439622764949 },
+         { 6.6846601778456245, 0.19399847157134323, 1.1778676907770447, 2256.5301003639406 },
+         { 6.2509900465335235, 0.26117835095484215, 2.0527197807208921, 2209.4746774081536 },
+         { 4.0367127835916792, 0.32979883608829003, 3.1965239321551597, 2162.7797561521274 },
+         { -0.035892848628075125, 0.39991121513495426, 4.6188674382438535, 2116.4474482324945 },
+         { -6.0490808255176809, 0.4715693490297711, 6.3298195457728896, 2070.4799166614239 },
+         { -14.089970266349553, 0.5448298387187952, 8.3399628827920935, 2024.8793785144362 },
+         { -24.250907287518199, 0.61975220576804135, 10.660427409673538, 1979.6481078470676 },
+         { -36.629859363321927, 0.69639908760795455, 13.302927134004339, 1934.7884388666203 },
+         { -51.330845619347059, 0.77483644881763003, 16.27979985612296, 1890.3027693887311 },
+         { -68.464406896965741, 0.8551338100076078, 19.604050241754802, 1846.1935646127067 },
+         { -88.148119896940997, 0.93736449603383953, 23.28939655154629, 1802.4633612544201 },
+         { -110.50716024400541, 1.0216059054706943, 27.350321394812696, 1759.1147720812289 },
+         { -135.67491992225627, 1.1079398034906716, 31.8021269171158, 1716.1504908999239 },
+         { -163.79368522455701, 1.1964526405459748, 36.660994878988447, 1673.5732980564239 },
+         { -195.01555956815517, 1.2872542974374641, 41.947522315406651, 1630.3845863466336 },
+         { -229.50672083565829, 1.3805019456689529, 47.691081928196475, 1587.314355528722 },
+         { -267.44678003643759, 1.4762921409817651, 53.909739654951181, 1544.9849472079366 },
+         { -309.17195038048726, 1.5750523388894768, 60.644488824670759, 1503.2535672775141 },
+      }
+   },
+   {
+      "G2 RK45", G2, 0.40000000000000002, 2400, 2, RK45, 2000, 80, 300, 15, 45,
+      0.16719758912202431,
+      {
+         { 2.4878950449128729, 0.06313614409041253, 0.11875295523760887, 2351.8712670391069 },
+         { 5.403989677565562, 0.12757275708043891, 0.48027249017195189, 2304.0971013176768 },
+         { 6.682479703700583, 0.19335426678401457, 1.0928522198488926, 2256.6793839747338 },
+         { 6.2537794618521803, 0.26052735299462798, 1.9652061502777318, 2209.6201196199754 },
+         { 4.0443668689910375, 0.32914096293260986, 3.1064715620723056, 2162.9213381296513 },
+         { -0.023454480120700671, 0.3992464085665981, 4.5262271780513341, 2116.5850645385226 },
+         { -6.0320010100603874, 0.47089767561874635, 6.2345508471534199, 2070.6134327399154 },
+         { -14.068457326914761, 0.54415149745971381, 8.242033338872325, 2025.0086136806683 },
+         { -24.225191715623808, 0.61906748702892445, 10.55980296962832, 1979.7727855253841 },
+         { -36.600266655243892, 0.69570845712640339, 13.199585393627958, 1934.9082187769093 },
+         { -51.297845638815687, 0.7741406048665419, 16.173738035990297, 1890.4172535609327 },
+         { -68.428592959942478, 0.85443366654483732, 19.495279002679698, 1846.3022531187758 },
+         { -88.11023918249191, 0.93666122055934409, 23.177943628728446, 1802.5656399311335 },
+         { -110.46822796556974, 1.0209010420111209, 27.236250673697228, 1759.2099421213038 },
+         { -135.63625548471794, 1.1072353130931063, 31.685541596268674, 1716.2377412490243 },
+         { -163.75694958277779, 1.1957509428168311, 36.542040239612525, 1673.6516734778431 },
+         { -194.98293974752147, 1.2865583064241699, 41.82635103337784, 1630.4515540627208 },
+         { -229.48097898270572, 1.3798153893076992, 47.567966088763384, 1587.3697406307374 },
+         { -267.43129803824445, 1.4756195830104248, 53.785066087978272, 1545.0274748183112 },
+         { -309.02605854808036, 1.5740667091361098, 60.49553864295526, 1503.4192148045747 },
+      }
+   },
+   {
+      "G5 trapezoidal", G5, 0.25, 2000, 1.75, Trapezoidal, 0, 59, 100, 5, 180,
+      0.10216661219869992,
+      {
+         { 0.33715131614905702, 0.07775950059850352, 2.7257160554432307e-17, 1897.5744202156295 },
+         { -0.0022718676841961471, 0.15897841830708748, 9.4496178465012108e-17, 1797.7568688959698 },
+         { -3.0334605893582776, 0.24478069344745623, 2.1113726283840426e-16, 1700.4246382262788 },
+         { -9.0725014703322895, 0.33550983572964832, 3.8087835576966199e-16, 1608.2601906013961 },
+         { -18.473838904618304, 0.43141713329745901, 6.0642860600815224e-16, 1521.7559990778293 },
+         { -31.630492307123433, 0.53275401658715349, 8.9050176528189772e-16, 1440.5287564761934 },
+         { -48.977740063552552, 0.63978165707829349, 1.235917850589286e-15, 1364.2239677377995 },
+         { -70.997222184889239, 0.75277116494713514, 1.645605606873062e-15, 1292.5136634115086 },
+         { -98.221342782267214, 0.87200782495441242, 2.1226501345917809e-15, 1224.6136475729677 },
+         { -131.24115034114959, 0.99778228736119245, 2.6701848793182505e-15, 1163.3562854443996 },
+         { -170.82062972282552, 1.1301609675539159, 3.2862288573696076e-15, 1112.9462189472529 },
+         { -217.28519529882209, 1.2674221245366541, 3.9576224174600448e-15, 1074.567764804495 },
+         { -271.26664322637816, 1.4091262899858299, 4.6769676598117324e-15, 1043.8005824790109 },
+         { -333.21412193582734, 1.5546768170436058, 5.4378627500095656e-15, 1018.2620550800134 },
+         { -403.5299663438513, 1.7036018570732998, 6.2352486829739093e-15, 996.82848324261818 },
+         { -482.85697063388767, 1.8561445477721739, 7.069089856438218e-15, 976.65944819108472 },
+         { -571.02828909618677, 2.0112841810508346, 7.9337980387604029e-15, 957.3376005193436 },
+         { -669.00042650717137, 2.1700571726024633, 8.8351910088844747e-15, 938.69486178645479 },
+         { -776.49598404789936, 2.331409739539815, 9.7673247818368921e-15, 920.81886996224421 },
+         { -894.61309695496357, 2.4964177343257905, 1.0736451072471041e-14, 903.55668954478051 },
+      }
+   },
+   {
+      "G5 RK45", G5, 0.25, 2000, 1.75, RK45, 0, 59, 100, 5, 180,
+      0.10215196416083366,
+      {
+         { 0.33398372777436575, 0.076989664727396656, 2.1442401550087843e-17, 1897.8970032363218 },
+         { 0.0018395203867998047, 0.15818755463411441, 8.8236390664508202e-17, 1798.0581178875464 },
+         { -3.0224310555195641, 0.24396777592205651, 2.0441366941503849e-16, 1700.702709275427 },
+         { -9.0550052489200894, 0.33467445740209467, 3.7368287677288922e-16, 1608.5134867306517 },
+         { -18.450483944901233, 0.43055944492076498, 5.9875812818464285e-16, 1521.9859999797695 },
+         { -31.602145259887045, 0.53187482954413057, 8.8235618180120019e-16, 1440.7364779458978 },
+         { -48.9456813353314, 0.63888274998525618, 1.2273020781783717e-15, 1364.4099377617576 },
+         { -70.963381818616824, 0.75185570298201654, 1.6365324851849403e-15, 1292.6778933919475 },
+         { -98.188717186809527, 0.87108087867462192, 2.1131424198973095e-15, 1224.7532952579577 },
+         { -131.21383311797331, 0.99685251700076494, 2.6603028742967973e-15, 1163.4703218129109 },
+         { -170.6610037978266, 1.1287921605661062, 3.2739352539813993e-15, 1113.1813599008492 },
+         { -217.11914050089638, 1.2660650901885904, 3.9450438806155915e-15, 1074.7507692475247 },
+         { -271.10385308581994, 1.4078045025070707, 4.6642873081362518e-15, 1043.9442835297127 },
+         { -333.06956256733599, 1.553417440142286, 5.4252752990058023e-15, 1018.3739332507624 },
+         { -403.42495104581246, 1.7024368562814434, 6.222974540242063e-15, 996.9126893843021 },
+         { -482.54295183556985, 1.8545981402373917, 7.0545333510918822e-15, 976.78697791623517 },
+         { -570.79252575933265, 2.0099008911332872, 7.9199474113488789e-15, 957.43741853629422 },
+         { -668.55137835222911, 2.16835536669111, 8.8193272673732716e-15, 938.82473306198608 },
+         { -776.20614779184166, 2.3299719138150534, 9.7527844266323637e-15, 920.91248940398771 },
+         { -894.15249706584541, 2.4947610001047482, 1.0720431697315118e-14, 903.6668685075316 },
+      }
+   },
+};
+
+#endif